@@ -0,0 +1,178 @@
+#ifndef __itkBatchHessianRecursiveGaussianImageFilter_h
+#define __itkBatchHessianRecursiveGaussianImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkRecursiveGaussianLineKernel.h"
+#include "itkHessianOutputPixelTraits.h"
+#include "itkHessianCentralDifferences.h"
+#include "itkMultiThreader.h"
+#include "itkMutexLock.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class BatchHessianRecursiveGaussianImageFilter
+ * \brief Computes the Hessian of the recursive Gaussian smoothing of
+ * each image of a batch of images of the same size.
+ *
+ * The input is a stack of images of dimension ImageDimension - 1,
+ * the last direction of the input being the index of the image in
+ * the batch. The output has the same size, its pixel is the Hessian
+ * over the first ImageDimension - 1 directions, and the slice k along
+ * the last direction is the Hessian of the image k. StackImages
+ * builds the input from separate images.
+ *
+ * The result for each image is the same as the
+ * DiscreteHessianRecursiveGaussianImageFilter of the image with a
+ * double InternalRealType, or within float rounding with a float
+ * InternalRealType, since this filter smooths in double. But the
+ * whole batch is computed in a single multi-threaded section, without
+ * a mini-pipeline. The threads take the images one at a time from the
+ * batch, and each thread smooths the image along all of its
+ * directions and computes the central differences in buffers which
+ * are allocated once and reused for all of its images. The images of
+ * the batch are contiguous in the buffers, so the lines along a
+ * direction other than 0 are filtered together, as by the
+ * BlockedRecursiveGaussianImageFilter, without gathering them.
+ *
+ * The output pixel types are those of the HessianOutputPixelTraits.
+ *
+ * This filter needs all of the input, and produces all of the output.
+ *
+ * \sa DiscreteHessianRecursiveGaussianImageFilter
+ *
+ * \ingroup GradientFilters
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage,
+          typename TOutputImage = Image< SymmetricSecondRankTensor<
+                                           typename NumericTraits< typename TInputImage::PixelType >::RealType,
+                                           TInputImage::ImageDimension - 1 >,
+                                         TInputImage::ImageDimension > >
+class ITK_EXPORT BatchHessianRecursiveGaussianImageFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BatchHessianRecursiveGaussianImageFilter        Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Pixel Type of the input image */
+  typedef TInputImage                        InputImageType;
+  typedef typename InputImageType::PixelType PixelType;
+
+  /** Dimension of the stacked images, and of each image of the batch */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(SliceDimension, unsigned int, TInputImage::ImageDimension - 1);
+
+  /** Type of an image of the batch */
+  typedef Image< PixelType, SliceDimension > SliceImageType;
+
+  /** Type of the output Image */
+  typedef TOutputImage                                 OutputImageType;
+  typedef typename OutputImageType::PixelType          OutputPixelType;
+  typedef typename OutputImageType::RegionType         OutputImageRegionType;
+
+  /** Type of the one dimensional smoothing */
+  typedef RecursiveGaussianLineKernel<>     LineKernelType;
+  typedef typename LineKernelType::RealType RealType;
+
+  /** Type of the Hessian computed per pixel */
+  typedef SymmetricSecondRankTensor< RealType, SliceDimension >        TensorType;
+  typedef HessianOutputPixelTraits< OutputPixelType, SliceDimension >  OutputPixelTraitsType;
+
+  /** Type of the central difference stencil */
+  typedef HessianCentralDifferences< SliceDimension, RealType > StencilType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(BatchHessianRecursiveGaussianImageFilter, ImageToImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set Sigma value. Sigma is measured in the units of image spacing.  */
+  itkSetMacro( Sigma, double );
+  itkGetConstMacro( Sigma, double );
+
+  /** Define which normalization factor will be used for the Gaussian
+   * \sa DiscreteHessianRecursiveGaussianImageFilter::SetNormalizeAcrossScale */
+  itkSetMacro( NormalizeAcrossScale, bool );
+  itkGetConstMacro( NormalizeAcrossScale, bool );
+  itkBooleanMacro( NormalizeAcrossScale );
+
+  /** Set the factor by which the components are multiplied, in
+   * addition to the normalization across scale, before they are
+   * converted to the output pixel. It is recorded in the
+   * MetaDataDictionary of the outputs, under HessianOutputScaleKey().
+   * Default is 1.
+   * \sa DiscreteHessianRecursiveGaussianImageFilter::SetOutputScale */
+  itkSetMacro( OutputScale, double );
+  itkGetConstMacro( OutputScale, double );
+
+  /** Stack images of the same size into an input of this filter. The
+   * spacing and origin are those of the first image, the spacing along
+   * the last direction is 1. The pixels are copied, generating the
+   * images directly into the slices of a stacked image avoids the
+   * copy. */
+  static typename InputImageType::Pointer StackImages( const std::vector< const SliceImageType * > & images );
+
+  /** This filter needs all of the input, and produces all of the
+   * output. */
+  virtual void GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError );
+  virtual void EnlargeOutputRequestedRegion( DataObject *output );
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( InputHasNumericTraitsCheck,
+                   ( Concept::HasNumericTraits< PixelType > ) );
+  itkConceptMacro( OutputHasPixelTraitsCheck,
+                   ( Concept::HasPixelTraits< OutputPixelType > ) );
+  /** End concept checking */
+#endif
+
+protected:
+
+  BatchHessianRecursiveGaussianImageFilter();
+  virtual ~BatchHessianRecursiveGaussianImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  void GenerateData();
+
+private:
+
+  BatchHessianRecursiveGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                           //purposely not implemented
+
+  /** The threads compute images until all are done */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg );
+
+  void ComputeImages( ThreadIdType threadId );
+
+  double m_Sigma;
+  bool   m_NormalizeAcrossScale;
+  double m_OutputScale;
+
+  std::vector< typename LineKernelType::Pointer > m_LineKernels;
+
+  SizeValueType   m_NextImage;
+  SizeValueType   m_NumberOfCompletedImages;
+  SimpleMutexLock m_ImagesLock;
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBatchHessianRecursiveGaussianImageFilter.hxx"
+#endif
+
+#endif // __itkBatchHessianRecursiveGaussianImageFilter_h
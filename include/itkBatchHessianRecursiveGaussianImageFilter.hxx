@@ -0,0 +1,308 @@
+#ifndef __itkBatchHessianRecursiveGaussianImageFilter_hxx
+#define __itkBatchHessianRecursiveGaussianImageFilter_hxx
+
+#include "itkBatchHessianRecursiveGaussianImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage >
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::BatchHessianRecursiveGaussianImageFilter()
+{
+  m_Sigma = 1.0;
+  m_NormalizeAcrossScale = false;
+  m_OutputScale = 1.0;
+  m_NextImage = 0;
+  m_NumberOfCompletedImages = 0;
+
+  // one output per component for the structure of arrays layout
+  this->SetNumberOfRequiredOutputs( OutputPixelTraitsType::NumberOfOutputs );
+  for ( unsigned int k = 1; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+typename BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >::InputImageType::Pointer
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::StackImages( const std::vector< const SliceImageType * > & images )
+{
+  if ( images.empty() )
+    {
+    itkGenericExceptionMacro("At least one image is required.");
+    }
+
+  const typename SliceImageType::RegionType & sliceRegion = images[0]->GetLargestPossibleRegion();
+
+  typename InputImageType::RegionType region;
+  typename InputImageType::SpacingType spacing;
+  typename InputImageType::PointType origin;
+  for ( unsigned int i = 0; i < SliceDimension; ++i )
+    {
+    region.SetIndex( i, sliceRegion.GetIndex( i ) );
+    region.SetSize( i, sliceRegion.GetSize( i ) );
+    spacing[i] = images[0]->GetSpacing()[i];
+    origin[i] = images[0]->GetOrigin()[i];
+    }
+  region.SetIndex( SliceDimension, 0 );
+  region.SetSize( SliceDimension, images.size() );
+  spacing[SliceDimension] = 1.0;
+  origin[SliceDimension] = 0.0;
+
+  typename InputImageType::Pointer stacked = InputImageType::New();
+  stacked->SetRegions( region );
+  stacked->SetSpacing( spacing );
+  stacked->SetOrigin( origin );
+  stacked->Allocate();
+
+  PixelType *out = stacked->GetBufferPointer();
+  for ( unsigned int k = 0; k < images.size(); ++k )
+    {
+    if ( images[k]->GetLargestPossibleRegion().GetSize() != sliceRegion.GetSize() )
+      {
+      itkGenericExceptionMacro("The size of image " << k << " is " << images[k]->GetLargestPossibleRegion().GetSize()
+                               << ", the size of the first image is " << sliceRegion.GetSize() << ".");
+      }
+
+    ImageRegionConstIterator< SliceImageType > it( images[k], images[k]->GetLargestPossibleRegion() );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      *out++ = it.Get();
+      }
+    }
+
+  return stacked;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError )
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  // This filter needs all of the input
+  typename InputImageType::Pointer image = const_cast< InputImageType * >( this->GetInput() );
+
+  if ( image )
+    {
+    image->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion( DataObject *output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType *input = this->GetInput();
+  const typename InputImageType::RegionType & bufferedRegion = input->GetBufferedRegion();
+
+  for ( unsigned int d = 0; d < SliceDimension; ++d )
+    {
+    if ( bufferedRegion.GetSize( d ) < 4 )
+      {
+      itkExceptionMacro("The number of pixels along direction " << d << " is less than 4. This filter requires a minimum of four pixels along the dimension to be processed.");
+      }
+    }
+
+  // record the scale of the stored components, as the composite filter
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    EncapsulateMetaData< double >( this->GetOutput( k )->GetMetaDataDictionary(),
+                                   HessianOutputScaleKey(), m_OutputScale );
+    }
+
+  m_LineKernels.resize( SliceDimension );
+  for ( unsigned int d = 0; d < SliceDimension; ++d )
+    {
+    m_LineKernels[d] = LineKernelType::New();
+    m_LineKernels[d]->SetSigma( m_Sigma );
+    m_LineKernels[d]->InitializeCoefficients( input->GetSpacing()[d] );
+    }
+
+  m_NextImage = 0;
+  m_NumberOfCompletedImages = 0;
+
+  // a single multi-threaded section for the whole batch
+  const SizeValueType numberOfImages = bufferedRegion.GetSize( SliceDimension );
+  const ThreadIdType  numberOfThreads =
+    static_cast< ThreadIdType >( std::max< SizeValueType >( 1, std::min< SizeValueType >( this->GetNumberOfThreads(), numberOfImages ) ) );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_LineKernels.clear();
+}
+
+template< typename TInputImage, typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::ThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *self = static_cast< Self * >( info->UserData );
+
+  self->ComputeImages( info->ThreadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::ComputeImages( ThreadIdType threadId )
+{
+  const unsigned int NumberOfComponents = SliceDimension * ( SliceDimension + 1 ) / 2;
+
+  const InputImageType *input = this->GetInput();
+
+  // the input and the outputs are the whole stack, the images are
+  // contiguous in the buffers and have the same offset in each
+  const typename InputImageType::RegionType & region = input->GetBufferedRegion();
+  const OffsetValueType *stride = input->GetOffsetTable();
+  const SizeValueType    sliceSize = stride[SliceDimension];
+  const SizeValueType    numberOfImages = region.GetSize( SliceDimension );
+  const SizeValueType    ln = region.GetSize( 0 );
+
+  OutputPixelType *outputs[OutputPixelTraitsType::NumberOfOutputs];
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    outputs[k] = this->GetOutput( k )->GetBufferPointer();
+    }
+
+  // the central differences, times the output scale and the
+  // normalization across scale
+  StencilType stencil;
+  stencil.SetFactors( input->GetSpacing(), ( m_NormalizeAcrossScale ) ? m_OutputScale * m_Sigma * m_Sigma : m_OutputScale );
+
+  // the buffers of the thread, reused for all of its images
+  std::vector< RealType > smoothed( sliceSize );
+  std::vector< RealType > filtered( sliceSize );
+  std::vector< RealType > scratch( sliceSize );
+  std::vector< RealType > components( NumberOfComponents * ln );
+
+  OffsetValueType minus[SliceDimension];
+  OffsetValueType plus[SliceDimension];
+
+  while ( true )
+    {
+    m_ImagesLock.Lock();
+    const SizeValueType k = m_NextImage++;
+    m_ImagesLock.Unlock();
+
+    if ( k >= numberOfImages )
+      {
+      break;
+      }
+
+    const PixelType      *in = input->GetBufferPointer() + k * sliceSize;
+    const OffsetValueType outputOffset = k * sliceSize;
+
+    RealType *current = &smoothed[0];
+    RealType *next = &filtered[0];
+    for ( SizeValueType n = 0; n < sliceSize; ++n )
+      {
+      current[n] = static_cast< RealType >( in[n] );
+      }
+
+    // Smooth along the last direction first, as the composite filter.
+    // Along a direction d other than 0, the lines of each block of
+    // stride[d] * size[d] pixels are interleaved.
+    for ( int d = SliceDimension - 1; d > 0; --d )
+      {
+      const SizeValueType width = stride[d];
+      const SizeValueType blockSize = width * region.GetSize( d );
+      for ( SizeValueType o = 0; o < sliceSize; o += blockSize )
+        {
+        m_LineKernels[d]->FilterLines( next + o, current + o, &scratch[0], region.GetSize( d ), width );
+        }
+      std::swap( current, next );
+      }
+
+    for ( SizeValueType o = 0; o < sliceSize; o += ln )
+      {
+      m_LineKernels[0]->FilterLine( next + o, current + o, &scratch[0], ln );
+      }
+    std::swap( current, next );
+
+    // Compute the central differences a line at a time, the neighbors
+    // at the boundary are the boundary pixels as with the
+    // ZeroFluxNeumannBoundaryCondition
+    for ( SizeValueType o = 0; o < sliceSize; o += ln )
+      {
+      SizeValueType position = o / ln;
+      for ( unsigned int i = 1; i < SliceDimension; ++i )
+        {
+        const SizeValueType index = position % region.GetSize( i );
+        position /= region.GetSize( i );
+        minus[i] = ( index > 0 ) ? -stride[i] : 0;
+        plus[i] = ( index + 1 < region.GetSize( i ) ) ? stride[i] : 0;
+        }
+
+      stencil.EvaluateLine( current + o, static_cast< OffsetValueType >( ln ), minus, plus, &components[0] );
+
+      // interleave the components into the output pixels
+      for ( SizeValueType x = 0; x < ln; ++x )
+        {
+        TensorType H;
+        const RealType *c = &components[x];
+        for ( unsigned int m = 0; m < NumberOfComponents; ++m, c += ln )
+          {
+          H[m] = *c;
+          }
+        OutputPixelTraitsType::Assign( H, outputs, outputOffset + o + x );
+        }
+      }
+
+    m_ImagesLock.Lock();
+    ++m_NumberOfCompletedImages;
+    if ( threadId == 0 )
+      {
+      this->UpdateProgress( static_cast< float >( m_NumberOfCompletedImages ) / numberOfImages );
+      }
+    m_ImagesLock.Unlock();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BatchHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "Sigma: " << m_Sigma << std::endl;
+  os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
+  os << "OutputScale: " << m_OutputScale << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkBatchHessianRecursiveGaussianImageFilter_hxx
@@ -0,0 +1,151 @@
+#ifndef __itkBlockedRecursiveGaussianImageFilter_h
+#define __itkBlockedRecursiveGaussianImageFilter_h
+
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkMutexLock.h"
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class BlockedRecursiveGaussianImageFilter
+ * \brief A RecursiveGaussianImageFilter which filters blocks of
+ * lines at once along the directions other than 0.
+ *
+ * Along a direction other than 0, the pixels of a line are strided
+ * through the buffer, and the RecursiveGaussianImageFilter touches a
+ * new cache line for every pixel of every line. This filter instead
+ * gathers a block of lines into a buffer where they are interleaved:
+ * the pixels at the same position of all of the lines of the block
+ * are contiguous. A block is a chunk of consecutive columns of a row
+ * along direction 0, whose width is a multiple of VectorWidth and
+ * such that the block holds at most BlockSize pixels, or several
+ * whole rows when the rows are short. The recursion then runs over
+ * the block, one position at a time, with a contiguous inner loop
+ * across the lines which the compiler vectorizes, and the block is
+ * scattered back to the output. The image is only accessed by
+ * contiguous runs of at least VectorWidth pixels, and the buffers of
+ * a thread do not depend on the size of the image.
+ *
+ * Along direction 0 the lines are contiguous, and the filter is the
+ * RecursiveGaussianImageFilter. The result is the same as the
+ * RecursiveGaussianImageFilter, up to the rounding of the arithmetic.
+ *
+ * Only scalar pixel types are supported.
+ *
+ * \ingroup ImageEnhancement
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT BlockedRecursiveGaussianImageFilter:
+    public RecursiveGaussianImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef BlockedRecursiveGaussianImageFilter                      Self;
+  typedef RecursiveGaussianImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                                     Pointer;
+  typedef SmartPointer< const Self >                               ConstPointer;
+
+  typedef typename Superclass::RealType              RealType;
+  typedef typename Superclass::ScalarRealType        ScalarRealType;
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(BlockedRecursiveGaussianImageFilter, RecursiveGaussianImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** The smallest number of interleaved lines of a block, a multiple
+   * of the number of samples of the vector registers. */
+  itkStaticConstMacro(VectorWidth, SizeValueType, 8);
+
+  /** Set the maximum number of pixels of a block of lines. A block
+   * holds at least VectorWidth lines, so it may be larger for lines
+   * longer than BlockSize / VectorWidth. The block and its two buffers
+   * should fit in the cache. Default is 32768. */
+  itkSetClampMacro( BlockSize, SizeValueType, 1, NumericTraits< SizeValueType >::max() );
+  itkGetConstMacro( BlockSize, SizeValueType );
+
+  /** The bytes of the buffers allocated by the threads during the last
+   * update, summed over the threads. */
+  itkGetConstMacro( ThreadBufferBytes, SizeValueType );
+
+  /** Filter width interleaved lines of ln samples from data into
+   * outs. Sample i of line c is at i * width + c. The scratch buffer
+   * must also have ln * width elements, the buffers must not overlap,
+   * and ln must be at least 4. The filter coefficients must have been
+   * computed for the spacing of the lines. */
+  void FilterLines( RealType *outs, const RealType *data, RealType *scratch,
+                    SizeValueType ln, SizeValueType width ) const;
+
+protected:
+
+  BlockedRecursiveGaussianImageFilter();
+  virtual ~BlockedRecursiveGaussianImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  void BeforeThreadedGenerateData();
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+
+private:
+
+  BlockedRecursiveGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                      //purposely not implemented
+
+  /** y = a1 * b1 + a2 * b2 + a3 * b3 + a4 * b4, for each line */
+  static void MultiplyAdd( RealType *y,
+                           const RealType *a1, ScalarRealType b1,
+                           const RealType *a2, ScalarRealType b2,
+                           const RealType *a3, ScalarRealType b3,
+                           const RealType *a4, ScalarRealType b4,
+                           SizeValueType width )
+  {
+    for ( SizeValueType c = 0; c < width; ++c )
+      {
+      y[c] = a1[c] * b1 + a2[c] * b2 + a3[c] * b3 + a4[c] * b4;
+      }
+  }
+
+  /** y -= a1 * b1 + a2 * b2 + a3 * b3 + a4 * b4, for each line */
+  static void MultiplySubtract( RealType *y,
+                                const RealType *a1, ScalarRealType b1,
+                                const RealType *a2, ScalarRealType b2,
+                                const RealType *a3, ScalarRealType b3,
+                                const RealType *a4, ScalarRealType b4,
+                                SizeValueType width )
+  {
+    for ( SizeValueType c = 0; c < width; ++c )
+      {
+      y[c] -= a1[c] * b1 + a2[c] * b2 + a3[c] * b3 + a4[c] * b4;
+      }
+  }
+
+  SizeValueType m_BlockSize;
+
+  SizeValueType   m_ThreadBufferBytes;
+  SimpleMutexLock m_ThreadBufferBytesLock;
+};
+
+/** The blocked filter allocates the buffers of its threads
+ * \sa HessianPipelineReport */
+template< typename TInputImage, typename TOutputImage >
+SizeValueType ComputeHessianStageInternalBytes( const BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage > *filter )
+{
+  return filter->GetThreadBufferBytes();
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBlockedRecursiveGaussianImageFilter.hxx"
+#endif
+
+#endif // __itkBlockedRecursiveGaussianImageFilter_h
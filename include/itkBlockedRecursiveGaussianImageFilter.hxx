@@ -0,0 +1,241 @@
+#ifndef __itkBlockedRecursiveGaussianImageFilter_hxx
+#define __itkBlockedRecursiveGaussianImageFilter_hxx
+
+#include "itkBlockedRecursiveGaussianImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage >
+BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::BlockedRecursiveGaussianImageFilter()
+{
+  m_BlockSize = 1 << 15;
+  m_ThreadBufferBytes = 0;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  m_ThreadBufferBytes = 0;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::FilterLines( RealType *outs, const RealType *data, RealType *scratch,
+               SizeValueType ln, SizeValueType width ) const
+{
+  // The operations of RecursiveSeparableImageFilter::FilterDataArray
+  // in the same order, on rows of width interleaved samples
+  const SizeValueType w = width;
+
+  // Causal direction pass, the first sample is assumed to extend to
+  // infinity
+  const RealType *v1 = data;
+
+  Self::MultiplyAdd( scratch, v1, this->m_N0, v1, this->m_N1, v1, this->m_N2, v1, this->m_N3, w );
+  Self::MultiplySubtract( scratch, v1, this->m_BN1, v1, this->m_BN2, v1, this->m_BN3, v1, this->m_BN4, w );
+
+  Self::MultiplyAdd( scratch + w, data + w, this->m_N0, v1, this->m_N1, v1, this->m_N2, v1, this->m_N3, w );
+  Self::MultiplySubtract( scratch + w, scratch, this->m_D1, v1, this->m_BN2, v1, this->m_BN3, v1, this->m_BN4, w );
+
+  Self::MultiplyAdd( scratch + 2 * w, data + 2 * w, this->m_N0, data + w, this->m_N1, v1, this->m_N2, v1, this->m_N3, w );
+  Self::MultiplySubtract( scratch + 2 * w, scratch + w, this->m_D1, scratch, this->m_D2, v1, this->m_BN3, v1, this->m_BN4, w );
+
+  Self::MultiplyAdd( scratch + 3 * w, data + 3 * w, this->m_N0, data + 2 * w, this->m_N1, data + w, this->m_N2,
+                     v1, this->m_N3, w );
+  Self::MultiplySubtract( scratch + 3 * w, scratch + 2 * w, this->m_D1, scratch + w, this->m_D2, scratch, this->m_D3,
+                          v1, this->m_BN4, w );
+
+  for ( SizeValueType i = 4; i < ln; ++i )
+    {
+    const RealType *x = data + i * w;
+    RealType       *y = scratch + i * w;
+    Self::MultiplyAdd( y, x, this->m_N0, x - w, this->m_N1, x - 2 * w, this->m_N2, x - 3 * w, this->m_N3, w );
+    Self::MultiplySubtract( y, y - w, this->m_D1, y - 2 * w, this->m_D2, y - 3 * w, this->m_D3, y - 4 * w, this->m_D4, w );
+    }
+
+  std::copy( scratch, scratch + ln * w, outs );
+
+  // AntiCausal direction pass, the last sample is assumed to extend
+  // to infinity
+  const RealType *v2 = data + ( ln - 1 ) * w;
+  RealType       *s = scratch + ( ln - 1 ) * w;
+
+  Self::MultiplyAdd( s, v2, this->m_M1, v2, this->m_M2, v2, this->m_M3, v2, this->m_M4, w );
+  Self::MultiplySubtract( s, v2, this->m_BM1, v2, this->m_BM2, v2, this->m_BM3, v2, this->m_BM4, w );
+
+  Self::MultiplyAdd( s - w, v2, this->m_M1, v2, this->m_M2, v2, this->m_M3, v2, this->m_M4, w );
+  Self::MultiplySubtract( s - w, s, this->m_D1, v2, this->m_BM2, v2, this->m_BM3, v2, this->m_BM4, w );
+
+  Self::MultiplyAdd( s - 2 * w, v2 - w, this->m_M1, v2, this->m_M2, v2, this->m_M3, v2, this->m_M4, w );
+  Self::MultiplySubtract( s - 2 * w, s - w, this->m_D1, s, this->m_D2, v2, this->m_BM3, v2, this->m_BM4, w );
+
+  Self::MultiplyAdd( s - 3 * w, v2 - 2 * w, this->m_M1, v2 - w, this->m_M2, v2, this->m_M3, v2, this->m_M4, w );
+  Self::MultiplySubtract( s - 3 * w, s - 2 * w, this->m_D1, s - w, this->m_D2, s, this->m_D3, v2, this->m_BM4, w );
+
+  for ( SizeValueType i = ln - 4; i > 0; --i )
+    {
+    const RealType *x = data + i * w;
+    RealType       *y = scratch + ( i - 1 ) * w;
+    Self::MultiplyAdd( y, x, this->m_M1, x + w, this->m_M2, x + 2 * w, this->m_M3, x + 3 * w, this->m_M4, w );
+    Self::MultiplySubtract( y, y + w, this->m_D1, y + 2 * w, this->m_D2, y + 3 * w, this->m_D3, y + 4 * w, this->m_D4, w );
+    }
+
+  // Roll the antiCausal part into the output
+  for ( SizeValueType k = 0; k < ln * w; ++k )
+    {
+    outs[k] += scratch[k];
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId)
+{
+  const unsigned int direction = this->GetDirection();
+
+  // the lines along direction 0 are contiguous
+  if ( direction == 0 )
+    {
+    Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+
+    // the input, output and scratch lines of the superclass
+    m_ThreadBufferBytesLock.Lock();
+    m_ThreadBufferBytes += 3 * outputRegionForThread.GetSize( 0 ) * sizeof( RealType );
+    m_ThreadBufferBytesLock.Unlock();
+    return;
+    }
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType      *output = this->GetOutput();
+
+  // the region of a thread holds complete lines along the direction
+  const SizeValueType   ln = outputRegionForThread.GetSize( direction );
+  const SizeValueType   rowLength = outputRegionForThread.GetSize( 0 );
+  const OffsetValueType inputStride = input->GetOffsetTable()[direction];
+  const OffsetValueType outputStride = output->GetOffsetTable()[direction];
+
+  const typename InputImageType::PixelType *in = input->GetBufferPointer();
+  typename OutputImageType::PixelType      *out = output->GetBufferPointer();
+
+  // the first pixel of each row of a line
+  OutputImageRegionType rowRegion = outputRegionForThread;
+  rowRegion.SetSize( 0, 1 );
+  rowRegion.SetSize( direction, 1 );
+
+  // A block is a chunk of columns of the rows along direction 0, a
+  // multiple of the vector width, such that the block holds at most
+  // BlockSize pixels. Short rows are grouped instead, several rows per
+  // block.
+  const SizeValueType vectorWidth = VectorWidth;
+  SizeValueType       columnsPerBlock =
+    std::max< SizeValueType >( vectorWidth, ( m_BlockSize / ln ) / vectorWidth * vectorWidth );
+  SizeValueType rowsPerBlock = 1;
+  if ( columnsPerBlock >= rowLength )
+    {
+    columnsPerBlock = rowLength;
+    rowsPerBlock = std::max< SizeValueType >( 1, m_BlockSize / ( rowLength * ln ) );
+    }
+
+  ProgressReporter progress( this, threadId, rowRegion.GetNumberOfPixels(), 10 );
+
+  std::vector< OffsetValueType > inputOffsets;
+  std::vector< OffsetValueType > outputOffsets;
+  std::vector< RealType >        block;
+  std::vector< RealType >        filtered;
+  std::vector< RealType >        scratch;
+
+  ImageRegionConstIteratorWithIndex< OutputImageType > rit( output, rowRegion );
+  rit.GoToBegin();
+  while ( !rit.IsAtEnd() )
+    {
+    inputOffsets.clear();
+    outputOffsets.clear();
+    for ( ; !rit.IsAtEnd() && inputOffsets.size() < rowsPerBlock; ++rit )
+      {
+      inputOffsets.push_back( input->ComputeOffset( rit.GetIndex() ) );
+      outputOffsets.push_back( output->ComputeOffset( rit.GetIndex() ) );
+      }
+
+    for ( SizeValueType first = 0; first < rowLength; first += columnsPerBlock )
+      {
+      const SizeValueType columns = std::min( columnsPerBlock, rowLength - first );
+      const SizeValueType width = inputOffsets.size() * columns;
+      block.resize( ln * width );
+      filtered.resize( ln * width );
+      scratch.resize( ln * width );
+
+      // gather the columns of the rows at each position along the
+      // direction
+      for ( SizeValueType i = 0; i < ln; ++i )
+        {
+        RealType *b = &block[i * width];
+        for ( SizeValueType r = 0; r < inputOffsets.size(); ++r )
+          {
+          const typename InputImageType::PixelType *row = in + inputOffsets[r] + i * inputStride + first;
+          for ( SizeValueType x = 0; x < columns; ++x )
+            {
+            *b++ = static_cast< RealType >( row[x] );
+            }
+          }
+        }
+
+      this->FilterLines( &filtered[0], &block[0], &scratch[0], ln, width );
+
+      // and scatter them back, the output may be the input
+      for ( SizeValueType i = 0; i < ln; ++i )
+        {
+        const RealType *b = &filtered[i * width];
+        for ( SizeValueType r = 0; r < outputOffsets.size(); ++r )
+          {
+          typename OutputImageType::PixelType *row = out + outputOffsets[r] + i * outputStride + first;
+          for ( SizeValueType x = 0; x < columns; ++x )
+            {
+            row[x] = static_cast< typename OutputImageType::PixelType >( *b++ );
+            }
+          }
+        }
+      }
+
+    for ( SizeValueType r = 0; r < outputOffsets.size(); ++r )
+      {
+      progress.CompletedPixel();
+      }
+    }
+
+  m_ThreadBufferBytesLock.Lock();
+  m_ThreadBufferBytes += ( block.capacity() + filtered.capacity() + scratch.capacity() ) * sizeof( RealType )
+    + ( inputOffsets.capacity() + outputOffsets.capacity() ) * sizeof( OffsetValueType );
+  m_ThreadBufferBytesLock.Unlock();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BlockedRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "BlockSize: " << m_BlockSize << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkBlockedRecursiveGaussianImageFilter_hxx
@@ -1,9 +1,13 @@
 #ifndef __itkDiscreteHessianRecursiveGaussianImageFilter_h
 #define __itkDiscreteHessianRecursiveGaussianImageFilter_h
 
-#include "itkRecursiveGaussianImageFilter.h"
+#include "itkBlockedRecursiveGaussianImageFilter.h"
 #include "itkSymmetricSecondRankTensor.h"
 #include "itkPixelTraits.h"
+#include "itkHessianOutputPixelTraits.h"
+#include "itkHessianPipelineReport.h"
+
+#include <vector>
 
 
 namespace itk
@@ -19,18 +23,68 @@ namespace Local
  * differences.
  *
  * This filter is a composite filter of the
- * RecursiveGaussianImageFilter and the HessianImageFilter.
+ * RecursiveGaussianImageFilter and the HessianImageFilter. The
+ * smoothing along the directions other than 0 is done by the
+ * BlockedRecursiveGaussianImageFilter, which filters blocks of lines
+ * at once instead of striding through the image for each line.
  *
  * The additional feature added is the normalization across scale.
  *
+ * By default the recursive Gaussian requires the whole input to
+ * produce any output. When UseStreaming is enabled, the input
+ * requested region is only the output requested region padded by
+ * StreamingSigmaMargin sigmas (plus the radius of the central
+ * differences), and the recursive filters are truncated to that
+ * region. This allows the filter to be streamed with memory
+ * proportional to the size of a chunk. The truncated filter is an
+ * approximation: the impulse response of the recursive Gaussian
+ * decays approximately as exp(-1.7 x/sigma), so the difference of a
+ * component of the output to the non-streamed output is on the order
+ * of exp(-1.7*margin) times the variation of the input over the
+ * margin. For the default margin of 6 sigma it is below 1e-4 times
+ * the range of the input values. The bound is absolute: where the
+ * Hessian is small compared to the input, the relative difference
+ * may be larger.
+ *
+ * When only the eigenvalues of the Hessian are needed, the output
+ * pixel may be a FixedArray of ImageDimension eigenvalues, optionally
+ * followed by the eigenvectors, and the eigen-analysis is done as the
+ * Hessian is computed. The tensor image is then never allocated.
+ *
+ * To reduce the size of the output the components may be float, or
+ * fixed-point integers with the quantization step 1/OutputScale. With
+ * a scalar output pixel the filter has one output per component.
+ * \sa HessianOutputPixelTraits
+ *
+ * When UseIncrementalUpdate is on, the output of an update is kept,
+ * and the regions of the input which change afterwards may be marked
+ * with AddDirtyRegion. The next update then only recomputes the
+ * output in the dirty region padded by StreamingSigmaMargin sigmas
+ * plus the radius of the central differences, as by the streaming
+ * mode, and patches the kept output in place. The time of an update is
+ * then proportional to the size of the padded dirty region rather than
+ * of the image. The patch has the accuracy of the streaming mode, and
+ * the output outside of the padded region is not updated, which is
+ * within the same tolerance since the impulse response has decayed
+ * there. Any change of the parameters of the filter, or of the
+ * regions of the input or output, causes a complete update.
+ *
+ * After an update, GetReport returns the time, memory and threading
+ * of each internal filter, which may also be appended as JSON to
+ * ReportFileName.
+ * \sa HessianPipelineReport
+ *
  * \ingroup GradientFilters
+ * \ingroup Streamed
  * \ingroup ITKDiscreteHessian
  */
 template< typename TInputImage,
           typename TOutputImage = Image< SymmetricSecondRankTensor<
                                            typename NumericTraits< typename TInputImage::PixelType >::RealType,
                                            TInputImage::ImageDimension >,
-                                         TInputImage::ImageDimension > >
+                                         TInputImage::ImageDimension >,
+          typename TInternalRealType = typename NumericTraits<
+                                         typename PixelTraits< typename TOutputImage::PixelType >::ValueType >::FloatType >
 class ITK_EXPORT DiscreteHessianRecursiveGaussianImageFilter:
   public ImageToImageFilter< TInputImage, TOutputImage >
 {
@@ -49,10 +103,19 @@ public:
   /** Image dimension. */
   itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
 
+  typedef typename InputImageType::RegionType           InputImageRegionType;
+
   /** Type of the output Image */
   typedef TOutputImage                                       OutputImageType;
   typedef typename          OutputImageType::PixelType       OutputPixelType;
   typedef typename PixelTraits< OutputPixelType >::ValueType OutputComponentType;
+  typedef HessianOutputPixelTraits< OutputPixelType, ImageDimension > OutputPixelTraitsType;
+
+  /** Type of the intermediate smoothed images. By default it is the
+   * floating point type of the output components, so that a float
+   * output does not require double precision intermediate images. */
+  typedef TInternalRealType                          InternalRealType;
+  typedef Image< InternalRealType, ImageDimension >  RealImageType;
 
   /** Run-time type information (and related methods).   */
   itkTypeMacro(DiscreteHessianRecursiveGaussianImageFilter, ImageToImageFilter);
@@ -69,10 +132,107 @@ public:
   itkGetConstMacro( NormalizeAcrossScale, bool );
   itkBooleanMacro( NormalizeAcrossScale );
 
+  /** Set the factor by which the components are multiplied, in
+   * addition to the normalization across scale, before they are
+   * converted to the output pixel. For an integer output it is the
+   * inverse of the quantization step. It is recorded as a double in
+   * the MetaDataDictionary of the outputs, under
+   * HessianOutputScaleKey(). Default is 1. */
+  itkSetMacro( OutputScale, double );
+  itkGetConstMacro( OutputScale, double );
+
+  /** Enable the approximate streaming mode, where only the output
+   * requested region padded by StreamingSigmaMargin is requested from
+   * the input. Default is off. */
+  itkSetMacro( UseStreaming, bool );
+  itkGetConstMacro( UseStreaming, bool );
+  itkBooleanMacro( UseStreaming );
+
+  /** Set the padding of the input requested region used when
+   * UseStreaming is enabled. It is measured in number of sigmas,
+   * the default is 6.0. */
+  itkSetMacro( StreamingSigmaMargin, double );
+  itkGetConstMacro( StreamingSigmaMargin, double );
+
+  /** Smooth along direction 0 and compute the central differences in
+   * a single tiled pass with the
+   * FusedHessianRecursiveGaussianImageFilter, instead of a
+   * RecursiveGaussianImageFilter followed by the HessianImageFilter.
+   * This avoids one pass over an intermediate real image. The result
+   * is the same when InternalRealType is double. The fused kernel
+   * keeps the values smoothed along direction 0 in double, so with a
+   * float InternalRealType the results agree within float rounding.
+   * Default is on. */
+  itkSetMacro( UseFusedKernel, bool );
+  itkGetConstMacro( UseFusedKernel, bool );
+  itkBooleanMacro( UseFusedKernel );
+
+  /** Run all of the smoothing passes and the central differences as
+   * dependent tasks on tiles of the image, with the
+   * TiledHessianRecursiveGaussianImageFilter, instead of updating one
+   * internal filter per direction. The threads only wait for each
+   * other after the smoothing along the last direction. UseFusedKernel
+   * is ignored. The result is the same as with UseFusedKernel.
+   * Default is off. */
+  itkSetMacro( UseTaskScheduler, bool );
+  itkGetConstMacro( UseTaskScheduler, bool );
+  itkBooleanMacro( UseTaskScheduler );
+
+  /** Process images larger than the physical memory: the intermediate
+   * smoothed image and the outputs are backed by memory mapped
+   * scratch files in MemoryMappingDirectory, and the passes are run
+   * by the TiledHessianRecursiveGaussianImageFilter, which reads the
+   * files by whole rows. The input is not mapped: it must still fit
+   * in memory, unless it is itself memory mapped upstream. Memory
+   * mapping is only available on POSIX systems, elsewhere a warning is
+   * emitted and the buffers are allocated in memory. UseTaskScheduler
+   * and UseFusedKernel are ignored. Default is off.
+   * \sa MemoryMappedImportImageContainer */
+  itkSetMacro( UseMemoryMapping, bool );
+  itkGetConstMacro( UseMemoryMapping, bool );
+  itkBooleanMacro( UseMemoryMapping );
+
+  /** Set the directory of the scratch files. Default is the TMPDIR
+   * environment variable, or /tmp. */
+  itkSetStringMacro( MemoryMappingDirectory );
+  itkGetStringMacro( MemoryMappingDirectory );
+
+  /** Keep the output, and only recompute the neighborhood of the
+   * dirty regions of the input on the next update. Default is off. */
+  itkSetMacro( UseIncrementalUpdate, bool );
+  itkGetConstMacro( UseIncrementalUpdate, bool );
+  itkBooleanMacro( UseIncrementalUpdate );
+
+  /** Mark a region of the input as changed since the last update. The
+   * dirty region is the bounding box of the marked regions, it is
+   * cleared by an update. The input itself must also be modified for
+   * the filter to update. */
+  void AddDirtyRegion( const InputImageRegionType & region );
+
+  /** Forget the marked regions, the next update is complete */
+  void ClearDirtyRegion()
+  {
+    m_DirtyRegion = InputImageRegionType();
+  }
+
+  itkGetConstReferenceMacro( DirtyRegion, InputImageRegionType );
+
+  /** Get the measurements of the internal filters of the last update */
+  const HessianPipelineReport & GetReport() const
+  {
+    return m_Report;
+  }
+
+  /** Set a file to which the report of each update is appended, as a
+   * JSON object per line. Default is empty, no file is written. */
+  itkSetStringMacro( ReportFileName );
+  itkGetStringMacro( ReportFileName );
+
   /** DiscreteHessianRecursiveGaussianImageFilter needs all of the input to produce an
    * output. Therefore, DiscreteHessianRecursiveGaussianImageFilter needs to provide
    * an implementation for GenerateInputRequestedRegion in order to inform
-   * the pipeline execution model.
+   * the pipeline execution model. When UseStreaming is enabled only a
+   * padded region is requested.
    * \sa ImageToImageFilter::GenerateInputRequestedRegion() */
   virtual void GenerateInputRequestedRegion()
   throw( InvalidRequestedRegionError );
@@ -96,38 +256,41 @@ protected:
 
 private:
 
+  /** Patch the kept output in the neighborhood of the dirty region,
+   * return false if a complete update is needed */
+  bool GenerateIncrementalData( ProgressAccumulator *progress );
+
+  /** The name of a stage along a direction in the report */
+  static std::string GetStageName( const char *filterName, unsigned int direction );
+
   DiscreteHessianRecursiveGaussianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                      //purposely not implemented
 
-  // special binary functor to perform A+B*ConstValue
-  //
-  class MultHessianComponentwiseConstFunctor
-  {
-  public:
-    typedef MultHessianComponentwiseConstFunctor Self;
+  /** Normalize the image across scale space */
+  bool m_NormalizeAcrossScale;
+  double m_Sigma;
+  double m_OutputScale;
 
-    MultHessianComponentwiseConstFunctor( void ) : m_Value( NumericTraits<OutputPixelType>::One ) {}
+  bool   m_UseStreaming;
+  double m_StreamingSigmaMargin;
 
-    bool operator!=( const Self &other ) const { return !(*this==other); }
-    bool operator==( const Self &other ) const { return m_Value == other.m_Value; }
+  bool m_UseFusedKernel;
+  bool m_UseTaskScheduler;
 
-    inline OutputPixelType operator()( const OutputPixelType &a ) const
-    {
-      OutputPixelType o;
-      for ( unsigned int i = 0; i < m_Value.GetNumberOfComponents(); ++i )
-        {
-        o.SetNthComponent( i, a.GetNthComponent(i) * m_Value.GetNthComponent(i) );
-        }
-      return o;
-    }
+  bool        m_UseMemoryMapping;
+  std::string m_MemoryMappingDirectory;
 
-    OutputPixelType m_Value;
-  };
+  HessianPipelineReport m_Report;
+  std::string           m_ReportFileName;
 
+  bool                                             m_UseIncrementalUpdate;
+  InputImageRegionType                             m_DirtyRegion;
+  std::vector< typename OutputImageType::Pointer > m_KeptOutputs;
+  ModifiedTimeType                                 m_KeptOutputsMTime;
 
-  /** Normalize the image across scale space */
-  bool m_NormalizeAcrossScale;
-  double m_Sigma;
+  /** The streamed filter of the incremental updates, kept so that its
+   * kernels and buffers are reused */
+  Pointer m_IncrementalFilter;
 };
 
 
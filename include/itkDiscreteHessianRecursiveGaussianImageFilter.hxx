@@ -3,7 +3,15 @@
 
 #include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
 #include "itkHessianImageFilter.h"
-#include "itkUnaryFunctorImageFilter.h"
+#include "itkFusedHessianRecursiveGaussianImageFilter.h"
+#include "itkTiledHessianRecursiveGaussianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMetaDataObject.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 namespace itk
 {
@@ -14,17 +22,32 @@ namespace Local
 /**
  * Constructor
  */
-template< typename TInputImage, typename TOutputImage >
-DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::DiscreteHessianRecursiveGaussianImageFilter()
 {
   m_NormalizeAcrossScale = false;
   m_Sigma = 1.0;
+  m_OutputScale = 1.0;
+  m_UseStreaming = false;
+  m_UseFusedKernel = true;
+  m_UseTaskScheduler = false;
+  m_UseMemoryMapping = false;
+  m_UseIncrementalUpdate = false;
+  m_KeptOutputsMTime = 0;
+  m_StreamingSigmaMargin = 6.0;
+
+  // one output per component for the structure of arrays layout
+  this->SetNumberOfRequiredOutputs( OutputPixelTraitsType::NumberOfOutputs );
+  for ( unsigned int k = 1; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+    }
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::GenerateInputRequestedRegion()
   throw( InvalidRequestedRegionError )
 {
@@ -33,127 +56,401 @@ DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
   typename InputImageType::Pointer image = const_cast< InputImageType * >( this->GetInput() );
 
-  if ( image )
+  if ( !image )
+    {
+    return;
+    }
+
+  if ( !m_UseStreaming )
     {
+    // This filter needs all of the input
     image->SetRequestedRegionToLargestPossibleRegion();
+    return;
     }
+
+  // pad by the truncated support of the Gaussian, and the radius of
+  // the central differences
+  const typename InputImageType::SpacingType &spacing = image->GetSpacing();
+  typename InputImageType::SizeType radius;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    radius[i] = 1 + Math::Ceil< SizeValueType >( m_StreamingSigmaMargin * m_Sigma / spacing[i] );
+    }
+
+  typename InputImageType::RegionType inputRequestedRegion = image->GetRequestedRegion();
+  inputRequestedRegion.PadByRadius( radius );
+
+  // crop the input requested region at the input's largest possible region
+  if ( inputRequestedRegion.Crop( image->GetLargestPossibleRegion() ) )
+    {
+    image->SetRequestedRegion( inputRequestedRegion );
+    return;
+    }
+
+  // store what we tried to request (prior to trying to crop)
+  image->SetRequestedRegion( inputRequestedRegion );
+
+  InvalidRequestedRegionError e(__FILE__, __LINE__);
+  e.SetLocation(ITK_LOCATION);
+  e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+  e.SetDataObject(image);
+  throw e;
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::GenerateData(void)
 {
   itkDebugMacro(<< "DiscreteHessianRecursiveGaussianImageFilter generating data ");
 
   // let the last filter allocate the output, we don't need it untill
   // then
-  this->GetOutput()->ReleaseData();
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->GetOutput( k )->ReleaseData();
+    }
+
+  // record the scale of the stored components, so that an integer
+  // output can be decoded
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    EncapsulateMetaData< double >( this->GetOutput( k )->GetMetaDataDictionary(),
+                                   HessianOutputScaleKey(), this->m_OutputScale );
+    }
 
   // Create a process accumulator for tracking the progress of this
   // minipipeline
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
 
+  if ( this->GenerateIncrementalData( progress ) )
+    {
+    return;
+    }
 
   // Get the input and output pointers
   typename InputImageType::ConstPointer  input = this->GetInput();
   typename OutputImageType::Pointer      output = this->GetOutput();
 
+  const typename OutputImageType::RegionType outputLargestRegion = output->GetLargestPossibleRegion();
 
-  typedef itk::Image< double, ImageDimension> RealImageType;
-  typedef itk::RecursiveGaussianImageFilter< InputImageType, RealImageType > FirstGaussianFilterType;
-  typedef itk::RecursiveGaussianImageFilter< RealImageType, RealImageType > RealGaussianFilterType;
+  if ( m_UseStreaming )
+    {
+    // Restrict the mini-pipeline to the requested region of the
+    // input. The recursive filters process complete lines of their
+    // largest possible region, so use a shallow copy of the input
+    // whose largest possible region is the padded requested region.
+    typename InputImageType::Pointer localInput = InputImageType::New();
+    localInput->Graft( input.GetPointer() );
+    localInput->SetLargestPossibleRegion( input->GetRequestedRegion() );
+    input = localInput.GetPointer();
+    }
 
-  // The first Gaussian filter in the mini pipeline
-  //
-  // Convert the input to the real pixel type,
-  // Do not perform operation in-place as not to steal input data
-  typename FirstGaussianFilterType::Pointer firstGaussian = FirstGaussianFilterType::New();
-  firstGaussian->SetOrder( FirstGaussianFilterType::ZeroOrder );
-  firstGaussian->SetNormalizeAcrossScale( false );
-  firstGaussian->SetSigma( this->m_Sigma );
-  firstGaussian->SetDirection( ImageDimension - 1 );
-  firstGaussian->InPlaceOff();
-  firstGaussian->ReleaseDataFlagOn();
-  firstGaussian->SetInput( input );
-
-  progress->RegisterInternalFilter( firstGaussian,  1.0/(ImageDimension+1) );
-
-
-  // Assemble remaining gaussian filters
-  // All are inplace and real image to real image
-  typename RealGaussianFilterType::Pointer gaussianFilters[ImageDimension - 1];
-  for( unsigned int i = 0; i < ImageDimension-1; ++i )
-    {
-    gaussianFilters[i] = RealGaussianFilterType::New();
-    if ( i == 0 )
+  typename ImageSource<OutputImageType>::Pointer lastFilter;
+
+  // measure the internal filters, the progress weights are from the
+  // measurements of the previous run
+  const bool         tiled = this->m_UseTaskScheduler || this->m_UseMemoryMapping;
+  const unsigned int numberOfStages = tiled ? 1 : ( this->m_UseFusedKernel ? ImageDimension : ImageDimension + 1 );
+  m_Report.Start( this->GetNameOfClass(), numberOfStages );
+
+  // the normalization across scale is applied by the central
+  // differences
+  double scale = this->m_OutputScale;
+  if ( this->m_NormalizeAcrossScale )
+    {
+    scale *= vnl_math_sqr( this->m_Sigma );
+    }
+
+  if ( tiled )
+    {
+    // all of the smoothing and the central differences are scheduled
+    // as tasks on tiles in a single multi-threaded section
+    typedef TiledHessianRecursiveGaussianImageFilter< InputImageType, OutputImageType, InternalRealType > TiledHessianFilterType;
+    typename TiledHessianFilterType::Pointer tiledHessian = TiledHessianFilterType::New();
+    tiledHessian->SetInput( input );
+    tiledHessian->SetSigma( this->m_Sigma );
+    tiledHessian->SetScale( scale );
+    tiledHessian->SetNumberOfThreads( this->GetNumberOfThreads() );
+    tiledHessian->SetUseMemoryMapping( this->m_UseMemoryMapping );
+    tiledHessian->SetMemoryMappingDirectory( this->m_MemoryMappingDirectory );
+
+    progress->RegisterInternalFilter( tiledHessian,
+                                      m_Report.AddStage( tiledHessian.GetPointer(), "TiledHessianRecursiveGaussianImageFilter", 1.0 ) );
+
+    lastFilter = tiledHessian.GetPointer();
+    }
+  else
+    {
+    typedef BlockedRecursiveGaussianImageFilter< InputImageType, RealImageType > FirstGaussianFilterType;
+    typedef BlockedRecursiveGaussianImageFilter< RealImageType, RealImageType > RealGaussianFilterType;
+
+    // The first Gaussian filter in the mini pipeline
+    //
+    // Convert the input to the real pixel type,
+    // Do not perform operation in-place as not to steal input data
+    typename FirstGaussianFilterType::Pointer firstGaussian = FirstGaussianFilterType::New();
+    firstGaussian->SetOrder( FirstGaussianFilterType::ZeroOrder );
+    firstGaussian->SetNormalizeAcrossScale( false );
+    firstGaussian->SetSigma( this->m_Sigma );
+    firstGaussian->SetDirection( ImageDimension - 1 );
+    firstGaussian->InPlaceOff();
+    firstGaussian->ReleaseDataFlagOn();
+    firstGaussian->SetInput( input );
+
+    progress->RegisterInternalFilter( firstGaussian,
+                                      m_Report.AddStage( firstGaussian.GetPointer(),
+                                                         Self::GetStageName( "BlockedRecursiveGaussianImageFilter", ImageDimension - 1 ),
+                                                         1.0/(ImageDimension+1) ) );
+
+
+    // Assemble remaining gaussian filters, direction 0 is smoothed by
+    // the fused Hessian filter when it is used
+    // All are inplace and real image to real image
+    const unsigned int numberOfGaussianFilters = ( this->m_UseFusedKernel ) ? ImageDimension - 2 : ImageDimension - 1;
+    std::vector< typename RealGaussianFilterType::Pointer > gaussianFilters( numberOfGaussianFilters );
+    RealImageType *smoothed = firstGaussian->GetOutput();
+    for( unsigned int i = 0; i < numberOfGaussianFilters; ++i )
       {
-      gaussianFilters[i]->SetInput( firstGaussian->GetOutput() );
+      gaussianFilters[i] = RealGaussianFilterType::New();
+      gaussianFilters[i]->SetInput( smoothed );
+      gaussianFilters[i]->SetOrder( RealGaussianFilterType::ZeroOrder );
+      gaussianFilters[i]->SetNormalizeAcrossScale( false );
+      gaussianFilters[i]->SetSigma( this->m_Sigma );
+      gaussianFilters[i]->SetDirection( ImageDimension-i-2 );
+      gaussianFilters[i]->InPlaceOn();
+      gaussianFilters[i]->ReleaseDataFlagOn();
+
+      progress->RegisterInternalFilter( gaussianFilters[i],
+                                        m_Report.AddStage( gaussianFilters[i].GetPointer(),
+                                                           Self::GetStageName( "BlockedRecursiveGaussianImageFilter", ImageDimension-i-2 ),
+                                                           1.0/(ImageDimension+1) ) );
+
+      smoothed = gaussianFilters[i]->GetOutput();
+      }
+
+    if ( this->m_UseFusedKernel )
+      {
+      // smooth along direction 0 and compute the central differences
+      // in one pass
+      typedef FusedHessianRecursiveGaussianImageFilter<RealImageType, OutputImageType> FusedHessianFilterType;
+      typename FusedHessianFilterType::Pointer fusedHessian = FusedHessianFilterType::New();
+      fusedHessian->SetInput( smoothed );
+      fusedHessian->SetSigma( this->m_Sigma );
+      fusedHessian->SetScale( scale );
+
+      progress->RegisterInternalFilter( fusedHessian,
+                                        m_Report.AddStage( fusedHessian.GetPointer(), "FusedHessianRecursiveGaussianImageFilter",
+                                                           2.0/(ImageDimension+1) ) );
+
+      lastFilter = fusedHessian.GetPointer();
       }
     else
       {
-      gaussianFilters[i]->SetInput( gaussianFilters[i-1]->GetOutput() );
+      typedef itk::Local::HessianImageFilter<RealImageType, OutputImageType> HessianImageFilterType;
+      typename HessianImageFilterType::Pointer hessian = HessianImageFilterType::New();
+      hessian->SetInput( smoothed );
+      hessian->SetScale( scale );
+
+      progress->RegisterInternalFilter( hessian,
+                                        m_Report.AddStage( hessian.GetPointer(), "HessianImageFilter", 1.0/(ImageDimension+1) ) );
+
+      lastFilter = hessian.GetPointer();
       }
-    gaussianFilters[i]->SetOrder( RealGaussianFilterType::ZeroOrder );
-    gaussianFilters[i]->SetNormalizeAcrossScale( false );
-    gaussianFilters[i]->SetSigma( this->m_Sigma );
-    gaussianFilters[i]->SetDirection( ImageDimension-i-2 );
-    gaussianFilters[i]->InPlaceOn();
-    gaussianFilters[i]->ReleaseDataFlagOn();
+    }
+
+  // Perform standard graft-update-graft
+  //
+  // This saves memory, and copies the requested region to the filter
+  // so that last filter updates the correct region
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    lastFilter->GraftNthOutput( k, this->GetOutput( k ) );
+    }
+  lastFilter->Update();
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->GraftNthOutput( k, lastFilter->GetOutput( k ) );
 
-    progress->RegisterInternalFilter( gaussianFilters[i],  1.0/(ImageDimension+1) );
+    // the mini-pipeline may have had a truncated largest possible region
+    this->GetOutput( k )->SetLargestPossibleRegion( outputLargestRegion );
     }
 
+  m_Report.Finish( this->GetOutput()->GetRequestedRegion().GetNumberOfPixels(), this->GetNumberOfThreads() );
 
-  typedef itk::Local::HessianImageFilter<RealImageType, OutputImageType> HessianImageFilterType;
-  typename HessianImageFilterType::Pointer hessian = HessianImageFilterType::New();
-  hessian->SetInput( gaussianFilters[ ImageDimension - 2 ]->GetOutput() );
+  if ( !m_ReportFileName.empty() )
+    {
+    m_Report.AppendJSON( m_ReportFileName );
+    }
 
-  progress->RegisterInternalFilter( hessian, 1.0/(ImageDimension+1) );
+  // keep the output for the next incremental update
+  m_KeptOutputs.clear();
+  if ( m_UseIncrementalUpdate )
+    {
+    for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+      {
+      typename OutputImageType::Pointer keptOutput = OutputImageType::New();
+      keptOutput->Graft( this->GetOutput( k ) );
+      m_KeptOutputs.push_back( keptOutput );
+      }
+    m_KeptOutputsMTime = this->GetMTime();
+    }
+  this->ClearDirtyRegion();
+}
 
-  typename ImageSource<OutputImageType>::Pointer lastFilter = hessian.GetPointer();
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::AddDirtyRegion( const InputImageRegionType & region )
+{
+  if ( m_DirtyRegion.GetNumberOfPixels() == 0 )
+    {
+    m_DirtyRegion = region;
+    return;
+    }
 
-  if ( this->m_NormalizeAcrossScale )
+  // the bounding box of the dirty regions
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
     {
+    const IndexValueType begin = std::min( m_DirtyRegion.GetIndex( i ), region.GetIndex( i ) );
+    const IndexValueType end = std::max( m_DirtyRegion.GetIndex( i ) + static_cast< IndexValueType >( m_DirtyRegion.GetSize( i ) ),
+                                         region.GetIndex( i ) + static_cast< IndexValueType >( region.GetSize( i ) ) );
+    m_DirtyRegion.SetIndex( i, begin );
+    m_DirtyRegion.SetSize( i, end - begin );
+    }
+}
 
-    const typename InputImageType::SpacingType &spacing = input->GetSpacing();
-    OutputPixelType scales;
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+bool
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GenerateIncrementalData( ProgressAccumulator *progress )
+{
+  const InputImageType *input = this->GetInput();
+
+  // the kept output must be of the same parameters and regions
+  if ( !m_UseIncrementalUpdate
+       || m_KeptOutputs.size() != OutputPixelTraitsType::NumberOfOutputs
+       || m_KeptOutputsMTime != this->GetMTime()
+       || m_DirtyRegion.GetNumberOfPixels() == 0
+       || m_KeptOutputs[0]->GetLargestPossibleRegion() != this->GetOutput()->GetLargestPossibleRegion()
+       || m_KeptOutputs[0]->GetBufferedRegion() != this->GetOutput()->GetRequestedRegion()
+       || input->GetLargestPossibleRegion() != this->GetOutput()->GetLargestPossibleRegion() )
+    {
+    return false;
+    }
 
-    scales.Fill( vnl_math_sqr( this->m_Sigma ) );
+  // the output which depends on the dirty region, as the input
+  // requested region of the streaming mode
+  const typename InputImageType::SpacingType &spacing = input->GetSpacing();
+  typename InputImageType::SizeType radius;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    radius[i] = 1 + Math::Ceil< SizeValueType >( m_StreamingSigmaMargin * m_Sigma / spacing[i] );
+    }
 
+  typename OutputImageType::RegionType affectedRegion = m_DirtyRegion;
+  affectedRegion.PadByRadius( radius );
+  if ( !affectedRegion.Crop( m_KeptOutputs[0]->GetBufferedRegion() ) )
+    {
+    // the dirty region does not change the output
+    for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+      {
+      this->GraftNthOutput( k, m_KeptOutputs[k] );
+      }
+    this->ClearDirtyRegion();
+    return true;
+    }
+
+  m_Report.Start( this->GetNameOfClass(), 1 );
 
-    typedef itk::UnaryFunctorImageFilter< OutputImageType, OutputImageType, MultHessianComponentwiseConstFunctor > MultFilterType;
-    typename MultFilterType::Pointer multFilter = MultFilterType::New();
-    multFilter->GetFunctor().m_Value = scales;
-    multFilter->InPlaceOn();
-    multFilter->SetInput( hessian->GetOutput() );
+  // Compute the affected region in the streaming mode, from a shallow
+  // copy of the input so that the upstream pipeline is not updated
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( input );
 
-    lastFilter = multFilter;
+  if ( !m_IncrementalFilter )
+    {
+    m_IncrementalFilter = Self::New();
     }
+  Self *incremental = m_IncrementalFilter;
+  incremental->SetInput( localInput );
+  incremental->SetSigma( m_Sigma );
+  incremental->SetNormalizeAcrossScale( m_NormalizeAcrossScale );
+  incremental->SetOutputScale( m_OutputScale );
+  incremental->SetStreamingSigmaMargin( m_StreamingSigmaMargin );
+  incremental->SetUseFusedKernel( m_UseFusedKernel );
+  incremental->SetUseTaskScheduler( m_UseTaskScheduler );
+  incremental->SetUseMemoryMapping( m_UseMemoryMapping );
+  incremental->SetMemoryMappingDirectory( m_MemoryMappingDirectory );
+  incremental->SetNumberOfThreads( this->GetNumberOfThreads() );
+  incremental->UseStreamingOn();
+  incremental->UseIncrementalUpdateOff();
+
+  // the observers of the previous incremental update
+  incremental->RemoveAllObservers();
+
+  progress->RegisterInternalFilter( incremental,
+                                    m_Report.AddStage( incremental, "DiscreteHessianRecursiveGaussianImageFilter incremental", 1.0 ) );
+
+  incremental->GetOutput()->SetRequestedRegion( affectedRegion );
+  incremental->Update();
+
+  // patch the kept outputs in place
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    ImageRegionConstIterator< OutputImageType > it( incremental->GetOutput( k ), affectedRegion );
+    ImageRegionIterator< OutputImageType >      kit( m_KeptOutputs[k], affectedRegion );
+    for ( ; !it.IsAtEnd(); ++it, ++kit )
+      {
+      kit.Set( it.Get() );
+      }
+    m_KeptOutputs[k]->Modified();
 
+    this->GraftNthOutput( k, m_KeptOutputs[k] );
+    }
 
-  // Perform standard graft-update-graft
-  //
-  // This saves memory, and copies the requested region to the filter
-  // so that last filter updates the correct region
-  lastFilter->GraftOutput( output );
-  lastFilter->Update();
-  this->GraftOutput( lastFilter->GetOutput() );
+  m_Report.Finish( affectedRegion.GetNumberOfPixels(), this->GetNumberOfThreads() );
+
+  if ( !m_ReportFileName.empty() )
+    {
+    m_Report.AppendJSON( m_ReportFileName );
+    }
+
+  this->ClearDirtyRegion();
+  return true;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+std::string
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GetStageName( const char *filterName, unsigned int direction )
+{
+  std::ostringstream name;
+  name << filterName << " direction " << direction;
+  return name.str();
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
   os << "Sigma: " << m_Sigma << std::endl;
+  os << "OutputScale: " << m_OutputScale << std::endl;
+  os << "UseStreaming: " << m_UseStreaming << std::endl;
+  os << "StreamingSigmaMargin: " << m_StreamingSigmaMargin << std::endl;
+  os << "UseFusedKernel: " << m_UseFusedKernel << std::endl;
+  os << "UseTaskScheduler: " << m_UseTaskScheduler << std::endl;
+  os << "UseMemoryMapping: " << m_UseMemoryMapping << std::endl;
+  os << "MemoryMappingDirectory: " << m_MemoryMappingDirectory << std::endl;
+  os << "ReportFileName: " << m_ReportFileName << std::endl;
+  os << "UseIncrementalUpdate: " << m_UseIncrementalUpdate << std::endl;
+  os << "DirtyRegion: " << m_DirtyRegion << std::endl;
 }
 
 } // end namespace Local
@@ -0,0 +1,159 @@
+#ifndef __itkDiscreteHessianRecursiveGaussianImageFunction_h
+#define __itkDiscreteHessianRecursiveGaussianImageFunction_h
+
+#include "itkImageFunction.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkRecursiveGaussianLineKernel.h"
+#include "itkHessianCentralDifferences.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class DiscreteHessianRecursiveGaussianImageFunction
+ * \brief Computes the Hessian of the image smoothed by a recursive
+ * Gaussian at a sparse set of indices.
+ *
+ * For each evaluated index, only the neighborhood of the index within
+ * SigmaMargin sigmas, plus the radius of the central differences, is
+ * smoothed. The separable smoothing is done one direction at a time,
+ * and after each direction only the three slices around the index
+ * are kept, so the cost of an evaluation is dominated by the first
+ * pass over the neighborhood. The central differences are then
+ * computed at the index.
+ *
+ * The result differs from the DiscreteHessianRecursiveGaussianImageFilter
+ * by the truncation of the recursive Gaussian to the neighborhood,
+ * which is below 1e-4 relative to the variation of the input for the
+ * default margin of 6 sigma. The filter with UseStreaming enabled is
+ * truncated to other neighborhoods, those of its chunks, so both are
+ * within this bound of the non-streamed filter, but not the same.
+ *
+ * Neighborhoods of nearby indices overlap and are smoothed once per
+ * index. When the indices are dense, the filter is faster.
+ *
+ * \sa DiscreteHessianRecursiveGaussianImageFilter
+ *
+ * \ingroup ImageFunctions
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage, typename TCoordRep = double >
+class ITK_EXPORT DiscreteHessianRecursiveGaussianImageFunction:
+  public ImageFunction< TInputImage,
+                        SymmetricSecondRankTensor< double, TInputImage::ImageDimension >,
+                        TCoordRep >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DiscreteHessianRecursiveGaussianImageFunction Self;
+  typedef ImageFunction< TInputImage,
+                         SymmetricSecondRankTensor< double, TInputImage::ImageDimension >,
+                         TCoordRep >                    Superclass;
+  typedef SmartPointer< Self >                          Pointer;
+  typedef SmartPointer< const Self >                    ConstPointer;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(DiscreteHessianRecursiveGaussianImageFunction, ImageFunction);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                                InputImageType;
+  typedef typename InputImageType::PixelType         PixelType;
+  typedef typename Superclass::OutputType            OutputType;
+  typedef typename Superclass::PointType             PointType;
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::ContinuousIndexType   ContinuousIndexType;
+
+  /** Containers of the batch evaluation */
+  typedef std::vector< IndexType >  IndexContainerType;
+  typedef std::vector< OutputType > OutputContainerType;
+
+  /** Type of the one dimensional smoothing */
+  typedef RecursiveGaussianLineKernel<>     LineKernelType;
+  typedef typename LineKernelType::RealType RealType;
+
+  /** Type of the central difference stencil */
+  typedef HessianCentralDifferences< ImageDimension, RealType > StencilType;
+
+  /** Set the input image, the line kernels are initialized with its
+   * spacing. */
+  virtual void SetInputImage( const InputImageType *ptr );
+
+  /** Set Sigma value. Sigma is measured in the units of image spacing.  */
+  void SetSigma( double sigma );
+  itkGetConstMacro( Sigma, double );
+
+  /** Define if the Hessian is multiplied by sigma^2. Default is off. */
+  itkSetMacro( NormalizeAcrossScale, bool );
+  itkGetConstMacro( NormalizeAcrossScale, bool );
+  itkBooleanMacro( NormalizeAcrossScale );
+
+  /** The number of sigmas of the neighborhood smoothed around each
+   * index. Default is 6.
+   * \sa DiscreteHessianRecursiveGaussianImageFilter::SetStreamingSigmaMargin */
+  itkSetMacro( SigmaMargin, double );
+  itkGetConstMacro( SigmaMargin, double );
+
+  /** Evaluate the Hessian at the index */
+  virtual OutputType EvaluateAtIndex( const IndexType & index ) const;
+
+  /** Evaluate the Hessian at the index nearest to the point */
+  virtual OutputType Evaluate( const PointType & point ) const
+  {
+    IndexType index;
+    this->ConvertPointToNearestIndex( point, index );
+    return this->EvaluateAtIndex( index );
+  }
+
+  /** Evaluate the Hessian at the index nearest to the continuous index */
+  virtual OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & cindex ) const
+  {
+    IndexType index;
+    this->ConvertContinuousIndexToNearestIndex( cindex, index );
+    return this->EvaluateAtIndex( index );
+  }
+
+  /** Evaluate the Hessian at each of the indices */
+  void EvaluateAtIndices( const IndexContainerType & indices, OutputContainerType & outputs ) const;
+
+protected:
+
+  DiscreteHessianRecursiveGaussianImageFunction();
+  virtual ~DiscreteHessianRecursiveGaussianImageFunction() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Initialize the line kernel of each direction */
+  void Initialize();
+
+private:
+
+  DiscreteHessianRecursiveGaussianImageFunction(const Self &); //purposely not implemented
+  void operator=(const Self &);                               //purposely not implemented
+
+  /** Smooth the lines along a direction of a buffer with the given
+   * extent */
+  void SmoothLines( std::vector< RealType > & buffer, const SizeValueType *extent, unsigned int direction ) const;
+
+  double m_Sigma;
+  bool   m_NormalizeAcrossScale;
+  double m_SigmaMargin;
+
+  std::vector< typename LineKernelType::Pointer > m_LineKernels;
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDiscreteHessianRecursiveGaussianImageFunction.hxx"
+#endif
+
+#endif // __itkDiscreteHessianRecursiveGaussianImageFunction_h
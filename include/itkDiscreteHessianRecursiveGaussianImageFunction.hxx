@@ -0,0 +1,267 @@
+#ifndef __itkDiscreteHessianRecursiveGaussianImageFunction_hxx
+#define __itkDiscreteHessianRecursiveGaussianImageFunction_hxx
+
+#include "itkDiscreteHessianRecursiveGaussianImageFunction.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMath.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TCoordRep >
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::DiscreteHessianRecursiveGaussianImageFunction()
+{
+  m_Sigma = 1.0;
+  m_NormalizeAcrossScale = false;
+  m_SigmaMargin = 6.0;
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::SetInputImage( const InputImageType *ptr )
+{
+  Superclass::SetInputImage( ptr );
+  this->Initialize();
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::SetSigma( double sigma )
+{
+  if ( m_Sigma != sigma )
+    {
+    m_Sigma = sigma;
+    this->Initialize();
+    this->Modified();
+    }
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::Initialize()
+{
+  m_LineKernels.clear();
+
+  if ( !this->GetInputImage() )
+    {
+    return;
+    }
+
+  const typename InputImageType::SpacingType &spacing = this->GetInputImage()->GetSpacing();
+
+  m_LineKernels.resize( ImageDimension );
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    m_LineKernels[d] = LineKernelType::New();
+    m_LineKernels[d]->SetSigma( m_Sigma );
+    m_LineKernels[d]->InitializeCoefficients( spacing[d] );
+    }
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::SmoothLines( std::vector< RealType > & buffer, const SizeValueType *extent, unsigned int direction ) const
+{
+  OffsetValueType stride[ImageDimension];
+  stride[0] = 1;
+  for ( unsigned int k = 1; k < ImageDimension; ++k )
+    {
+    stride[k] = stride[k-1] * extent[k-1];
+    }
+
+  const SizeValueType   ln = extent[direction];
+  const OffsetValueType s = stride[direction];
+  const SizeValueType   numberOfLines = buffer.size() / ln;
+
+  std::vector< RealType > inputLine( ln );
+  std::vector< RealType > outputLine( ln );
+  std::vector< RealType > scratch( ln );
+
+  for ( SizeValueType l = 0; l < numberOfLines; ++l )
+    {
+    // offset of the first sample of line l
+    OffsetValueType offset = 0;
+    SizeValueType   r = l;
+    for ( unsigned int k = 0; k < ImageDimension; ++k )
+      {
+      if ( k != direction )
+        {
+        offset += ( r % extent[k] ) * stride[k];
+        r /= extent[k];
+        }
+      }
+
+    for ( SizeValueType i = 0; i < ln; ++i )
+      {
+      inputLine[i] = buffer[offset + i * s];
+      }
+
+    m_LineKernels[direction]->FilterLine( &outputLine[0], &inputLine[0], &scratch[0], ln );
+
+    for ( SizeValueType i = 0; i < ln; ++i )
+      {
+      buffer[offset + i * s] = outputLine[i];
+      }
+    }
+}
+
+template< typename TInputImage, typename TCoordRep >
+typename DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >::OutputType
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::EvaluateAtIndex( const IndexType & index ) const
+{
+  const InputImageType *input = this->GetInputImage();
+
+  if ( !input || m_LineKernels.size() != ImageDimension )
+    {
+    itkExceptionMacro( "The input image is not set." );
+    }
+
+  const typename InputImageType::RegionType &bufferedRegion = input->GetBufferedRegion();
+  const typename InputImageType::SpacingType &spacing = input->GetSpacing();
+
+  if ( !bufferedRegion.IsInside( index ) )
+    {
+    itkExceptionMacro( "The index " << index << " is outside the buffered region of the input." );
+    }
+
+  // the neighborhood smoothed for this index, padded as in the
+  // streamed filter
+  typename InputImageType::SizeType radius;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    radius[d] = 1 + Math::Ceil< SizeValueType >( m_SigmaMargin * m_Sigma / spacing[d] );
+    }
+
+  typename InputImageType::SizeType unitSize;
+  unitSize.Fill( 1 );
+  typename InputImageType::RegionType region( index, unitSize );
+  region.PadByRadius( radius );
+  region.Crop( bufferedRegion );
+
+  SizeValueType  extent[ImageDimension];
+  IndexValueType start[ImageDimension];
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    extent[d] = region.GetSize( d );
+    start[d] = region.GetIndex( d );
+    if ( extent[d] < 4 )
+      {
+      itkExceptionMacro( "The number of pixels along direction " << d << " is less than 4. The recursive Gaussian requires a minimum of four pixels along the dimension to be processed." );
+      }
+    }
+
+  std::vector< RealType > buffer;
+  buffer.reserve( region.GetNumberOfPixels() );
+
+  ImageRegionConstIterator< InputImageType > it( input, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    buffer.push_back( static_cast< RealType >( it.Get() ) );
+    }
+
+  // Smooth in the same order of directions as the filter. After each
+  // direction is smoothed, only the three slices around the index are
+  // needed.
+  std::vector< RealType > cropped;
+  for ( int d = ImageDimension - 1; d >= 0; --d )
+    {
+    this->SmoothLines( buffer, extent, d );
+
+    const IndexValueType first = std::max( index[d] - 1, start[d] );
+    const IndexValueType last = std::min( index[d] + 1, start[d] + static_cast< IndexValueType >( extent[d] ) - 1 );
+
+    SizeValueType croppedExtent[ImageDimension];
+    std::copy( extent, extent + ImageDimension, croppedExtent );
+    croppedExtent[d] = last - first + 1;
+
+    SizeValueType croppedSize = 1;
+    OffsetValueType stride[ImageDimension];
+    for ( unsigned int k = 0; k < ImageDimension; ++k )
+      {
+      stride[k] = ( k == 0 ) ? 1 : stride[k-1] * extent[k-1];
+      croppedSize *= croppedExtent[k];
+      }
+
+    cropped.resize( croppedSize );
+    for ( SizeValueType n = 0; n < croppedSize; ++n )
+      {
+      OffsetValueType offset = ( first - start[d] ) * stride[d];
+      SizeValueType   r = n;
+      for ( unsigned int k = 0; k < ImageDimension; ++k )
+        {
+        offset += ( r % croppedExtent[k] ) * stride[k];
+        r /= croppedExtent[k];
+        }
+      cropped[n] = buffer[offset];
+      }
+
+    buffer.swap( cropped );
+    extent[d] = croppedExtent[d];
+    start[d] = first;
+    }
+
+  // the central differences on the remaining neighborhood, the
+  // neighbors outside of the image are the nearest pixels inside as
+  // with the ZeroFluxNeumannBoundaryCondition
+  OffsetValueType stride[ImageDimension];
+  OffsetValueType center = 0;
+  OffsetValueType minus[ImageDimension];
+  OffsetValueType plus[ImageDimension];
+  for ( unsigned int k = 0; k < ImageDimension; ++k )
+    {
+    stride[k] = ( k == 0 ) ? 1 : stride[k-1] * extent[k-1];
+    const IndexValueType c = index[k] - start[k];
+    center += c * stride[k];
+    minus[k] = ( c > 0 ) ? -stride[k] : 0;
+    plus[k] = ( c + 1 < static_cast< IndexValueType >( extent[k] ) ) ? stride[k] : 0;
+    }
+
+  StencilType stencil;
+  stencil.SetFactors( spacing, ( m_NormalizeAcrossScale ) ? m_Sigma * m_Sigma : 1.0 );
+
+  OutputType H;
+  stencil.Evaluate( &buffer[center], minus, plus, H );
+
+  return H;
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::EvaluateAtIndices( const IndexContainerType & indices, OutputContainerType & outputs ) const
+{
+  outputs.resize( indices.size() );
+  for ( unsigned int k = 0; k < indices.size(); ++k )
+    {
+    outputs[k] = this->EvaluateAtIndex( indices[k] );
+    }
+}
+
+template< typename TInputImage, typename TCoordRep >
+void
+DiscreteHessianRecursiveGaussianImageFunction< TInputImage, TCoordRep >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "Sigma: " << m_Sigma << std::endl;
+  os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
+  os << "SigmaMargin: " << m_SigmaMargin << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkDiscreteHessianRecursiveGaussianImageFunction_hxx
@@ -0,0 +1,177 @@
+#ifndef __itkFusedHessianRecursiveGaussianImageFilter_h
+#define __itkFusedHessianRecursiveGaussianImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkRecursiveGaussianLineKernel.h"
+#include "itkHessianOutputPixelTraits.h"
+#include "itkHessianCentralDifferences.h"
+#include "itkProgressReporter.h"
+#include "itkMutexLock.h"
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class FusedHessianRecursiveGaussianImageFilter
+ * \brief Smooths along direction 0 with a recursive Gaussian and
+ * computes the Hessian by central differences in a single pass.
+ *
+ * This filter is the last stage of the mini-pipeline of the composite
+ * Hessian filters. Its input is expected to be already smoothed along
+ * all directions but 0. The image is processed in tiles of lines: the
+ * lines of a tile are smoothed along direction 0 into a small buffer,
+ * which holds three slices along the last direction, and the central
+ * differences are computed while the smoothed values are still in
+ * cache. No intermediate image smoothed along direction 0 is created.
+ *
+ * The result is the same as a RecursiveGaussianImageFilter along
+ * direction 0 followed by the HessianImageFilter, including the
+ * eigen-analysis for the output pixel types described in
+ * HessianOutputPixelTraits, when the image smoothed along direction 0
+ * would be double. The smoothed values are kept in double here, so
+ * when that image would be float the results agree within float
+ * rounding of the smoothed values.
+ *
+ * \ingroup GradientFilters
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage,
+          typename TOutputImage = Image< SymmetricSecondRankTensor<
+                                           typename NumericTraits< typename TInputImage::PixelType >::RealType,
+                                           TInputImage::ImageDimension >,
+                                         TInputImage::ImageDimension > >
+class ITK_EXPORT FusedHessianRecursiveGaussianImageFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef FusedHessianRecursiveGaussianImageFilter        Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Pixel Type of the input image */
+  typedef TInputImage                        InputImageType;
+  typedef typename InputImageType::PixelType PixelType;
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  /** Type of the output Image */
+  typedef TOutputImage                                 OutputImageType;
+  typedef typename OutputImageType::PixelType          OutputPixelType;
+  typedef typename OutputImageType::RegionType         OutputImageRegionType;
+
+  /** Type of the one dimensional smoothing */
+  typedef RecursiveGaussianLineKernel<>     LineKernelType;
+  typedef typename LineKernelType::RealType RealType;
+
+  /** Type of the Hessian computed per pixel */
+  typedef SymmetricSecondRankTensor< RealType, ImageDimension >        TensorType;
+  typedef HessianOutputPixelTraits< OutputPixelType, ImageDimension >  OutputPixelTraitsType;
+
+  /** Type of the weights of the components of the Hessian */
+  typedef FixedArray< double, ImageDimension * ( ImageDimension + 1 ) / 2 > ComponentWeightsType;
+
+  /** Type of the central difference stencil */
+  typedef HessianCentralDifferences< ImageDimension, RealType > StencilType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(FusedHessianRecursiveGaussianImageFilter, ImageToImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set Sigma value. Sigma is measured in the units of image spacing.  */
+  itkSetMacro( Sigma, double );
+  itkGetConstMacro( Sigma, double );
+
+  /** Set the factor by which all of the components are multiplied.
+   * Default is 1.
+   * \sa HessianImageFilter::SetScale */
+  itkSetMacro( Scale, double );
+  itkGetConstMacro( Scale, double );
+
+  /** Set the factor by which each component is multiplied. Default
+   * is 1 for all components.
+   * \sa HessianImageFilter::SetComponentWeights */
+  itkSetMacro( ComponentWeights, ComponentWeightsType );
+  itkGetConstReferenceMacro( ComponentWeights, ComponentWeightsType );
+
+  /** The bytes of the buffers allocated by the threads during the last
+   * update, summed over the threads. */
+  itkGetConstMacro( ThreadBufferBytes, SizeValueType );
+
+  /** The recursive Gaussian needs complete lines along direction 0,
+   * and the central differences need a radius of 1 in the other
+   * directions.
+   * \sa ImageToImageFilter::GenerateInputRequestedRegion() */
+  virtual void GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError );
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( InputHasNumericTraitsCheck,
+                   ( Concept::HasNumericTraits< PixelType > ) );
+  itkConceptMacro( OutputHasPixelTraitsCheck,
+                   ( Concept::HasPixelTraits< OutputPixelType > ) );
+  /** End concept checking */
+#endif
+
+protected:
+
+  FusedHessianRecursiveGaussianImageFilter();
+  virtual ~FusedHessianRecursiveGaussianImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  void BeforeThreadedGenerateData();
+
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
+
+  /** Compute the output region from an image which has the buffered
+   * region, spacing and smoothing expected of the input. The line
+   * kernel must have been initialized by BeforeThreadedGenerateData.
+   * The pixels are reported to progress, unless it is null. Returns
+   * the bytes of the buffers it allocated. */
+  template< typename TImage >
+  SizeValueType GenerateRegion(const TImage *input,
+                               const OutputImageRegionType& outputRegionForThread,
+                               ProgressReporter *progress);
+
+  /** Add the bytes of the buffers of a thread, from any thread */
+  void AddThreadBufferBytes( SizeValueType bytes );
+
+private:
+
+  FusedHessianRecursiveGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                           //purposely not implemented
+
+  double               m_Sigma;
+  double               m_Scale;
+  ComponentWeightsType m_ComponentWeights;
+
+  typename LineKernelType::Pointer m_LineKernel;
+
+  SizeValueType   m_ThreadBufferBytes;
+  SimpleMutexLock m_ThreadBufferBytesLock;
+};
+
+/** The fused filter allocates the buffers of its threads
+ * \sa HessianPipelineReport */
+template< typename TInputImage, typename TOutputImage >
+SizeValueType ComputeHessianStageInternalBytes( const FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage > *filter )
+{
+  return filter->GetThreadBufferBytes();
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFusedHessianRecursiveGaussianImageFilter.hxx"
+#endif
+
+#endif // __itkFusedHessianRecursiveGaussianImageFilter_h
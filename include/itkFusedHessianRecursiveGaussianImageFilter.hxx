@@ -0,0 +1,333 @@
+#ifndef __itkFusedHessianRecursiveGaussianImageFilter_hxx
+#define __itkFusedHessianRecursiveGaussianImageFilter_hxx
+
+#include "itkFusedHessianRecursiveGaussianImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage >
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::FusedHessianRecursiveGaussianImageFilter()
+{
+  m_Sigma = 1.0;
+  m_Scale = 1.0;
+  m_ComponentWeights.Fill( 1.0 );
+  m_ThreadBufferBytes = 0;
+
+  // one output per component for the structure of arrays layout
+  this->SetNumberOfRequiredOutputs( OutputPixelTraitsType::NumberOfOutputs );
+  for ( unsigned int k = 1; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+    }
+}
+
+/**
+ * Enlarge Input Requested Region
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError )
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  typename InputImageType::Pointer inputPtr = const_cast< InputImageType * >( this->GetInput() );
+
+  if ( !inputPtr )
+    {
+    return;
+    }
+
+  typename InputImageType::RegionType inputRequestedRegion = inputPtr->GetRequestedRegion();
+
+  // the hessian just needs a 1 radius neighborhood, except along
+  // direction 0 where the recursive Gaussian needs complete lines
+  typename InputImageType::SizeType radius;
+  radius.Fill( 1 );
+  radius[0] = 0;
+  inputRequestedRegion.PadByRadius( radius );
+
+  const typename InputImageType::RegionType &largestRegion = inputPtr->GetLargestPossibleRegion();
+  inputRequestedRegion.SetIndex( 0, largestRegion.GetIndex( 0 ) );
+  inputRequestedRegion.SetSize( 0, largestRegion.GetSize( 0 ) );
+
+  // crop the input requested region at the input's largest possible region
+  if ( inputRequestedRegion.Crop( largestRegion ) )
+    {
+    inputPtr->SetRequestedRegion( inputRequestedRegion );
+    return;
+    }
+
+  // store what we tried to request (prior to trying to crop)
+  inputPtr->SetRequestedRegion( inputRequestedRegion );
+
+  InvalidRequestedRegionError e(__FILE__, __LINE__);
+  e.SetLocation(ITK_LOCATION);
+  e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+  e.SetDataObject(inputPtr);
+  throw e;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  const InputImageType *input = this->GetInput();
+
+  if ( input->GetBufferedRegion().GetSize( 0 ) < 4 )
+    {
+    itkExceptionMacro("The number of pixels along direction 0 is less than 4. This filter requires a minimum of four pixels along the dimension to be processed.");
+    }
+
+  m_LineKernel = LineKernelType::New();
+  m_LineKernel->SetSigma( m_Sigma );
+  m_LineKernel->InitializeCoefficients( input->GetSpacing()[0] );
+
+  m_ThreadBufferBytes = 0;
+}
+
+/**
+ * Threaded Data Generation
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  this->AddThreadBufferBytes( this->GenerateRegion( this->GetInput(), outputRegionForThread, &progress ) );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::AddThreadBufferBytes( SizeValueType bytes )
+{
+  m_ThreadBufferBytesLock.Lock();
+  m_ThreadBufferBytes += bytes;
+  m_ThreadBufferBytesLock.Unlock();
+}
+
+/**
+ * Smoothing along direction 0 and central differences of a region
+ */
+template< typename TInputImage, typename TOutputImage >
+template< typename TImage >
+SizeValueType
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateRegion(const TImage *input,
+                 const OutputImageRegionType& outputRegionForThread,
+                 ProgressReporter *progress)
+{
+  typedef typename TImage::PixelType ImagePixelType;
+
+  // the direction along which slices are cached
+  const unsigned int R = ImageDimension - 1;
+
+  OutputImageType *output = this->GetOutput();
+
+  // the outputs have the same buffered region
+  OutputPixelType *outputs[OutputPixelTraitsType::NumberOfOutputs];
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    outputs[k] = this->GetOutput( k )->GetBufferPointer();
+    }
+
+  const typename TImage::RegionType bufferedRegion = input->GetBufferedRegion();
+
+  const SizeValueType  ln = bufferedRegion.GetSize( 0 );
+  const IndexValueType lineStart = bufferedRegion.GetIndex( 0 );
+
+  const IndexValueType sliceFirst = bufferedRegion.GetIndex( R );
+  const IndexValueType sliceLast = sliceFirst + static_cast< IndexValueType >( bufferedRegion.GetSize( R ) ) - 1;
+
+  StencilType stencil;
+  stencil.SetFactors( input->GetSpacing(), m_Scale, m_ComponentWeights );
+
+  // Split the region into blocks along direction 1, so that the three
+  // cached slices of a block are about 768KB. Each block also smooths
+  // the two rows around it along direction 1, so a block has at least
+  // minimumBlockRows rows, which bounds this overhead to 2/16 of the
+  // smoothing along direction 0, at the cost of larger slices when
+  // the lines are long. In 2D
+  // direction 1 is the direction of the slices, and there is a single
+  // block.
+  const SizeValueType  tileLines = std::max< SizeValueType >( 1, 32768 / ln );
+  const IndexValueType minimumBlockRows = 16;
+  SizeValueType linesPerRow = 1;
+  for ( unsigned int k = 2; k < R; ++k )
+    {
+    linesPerRow *= outputRegionForThread.GetSize( k ) + 2;
+    }
+
+  const IndexValueType blockBegin = outputRegionForThread.GetIndex( 1 );
+  const IndexValueType blockEnd = blockBegin + static_cast< IndexValueType >( outputRegionForThread.GetSize( 1 ) );
+  IndexValueType blockStep = blockEnd - blockBegin;
+  if ( ImageDimension > 2 )
+    {
+    blockStep = std::max( minimumBlockRows, static_cast< IndexValueType >( tileLines / linesPerRow ) - 2 );
+    }
+
+  std::vector< RealType > inputLine( ln );
+  std::vector< RealType > scratch( ln );
+  std::vector< RealType > sliceBuffer;
+
+  for ( IndexValueType b = blockBegin; b < blockEnd; b += blockStep )
+    {
+    OutputImageRegionType blockRegion = outputRegionForThread;
+    if ( ImageDimension > 2 )
+      {
+      blockRegion.SetIndex( 1, b );
+      blockRegion.SetSize( 1, std::min( blockStep, blockEnd - b ) );
+      }
+
+    // the lines which are smoothed for this block
+    typename TImage::RegionType tileRegion = blockRegion;
+    typename TImage::SizeType   radius;
+    radius.Fill( 1 );
+    radius[0] = 0;
+    radius[R] = 0;
+    tileRegion.PadByRadius( radius );
+    tileRegion.Crop( bufferedRegion );
+    tileRegion.SetIndex( 0, lineStart );
+    tileRegion.SetSize( 0, ln );
+
+    // strides of a cached slice, which is contiguous along direction 0
+    OffsetValueType sliceStride[ImageDimension];
+    sliceStride[0] = 1;
+    for ( unsigned int k = 1; k < R; ++k )
+      {
+      sliceStride[k] = sliceStride[k-1] * tileRegion.GetSize( k-1 );
+      }
+    const OffsetValueType sliceSize = sliceStride[R-1] * tileRegion.GetSize( R-1 );
+
+    sliceBuffer.resize( 3 * sliceSize );
+
+    const IndexValueType zBegin = blockRegion.GetIndex( R );
+    const IndexValueType zEnd = zBegin + static_cast< IndexValueType >( blockRegion.GetSize( R ) );
+
+    // Slice u is cached at position ( u - zBegin + 1 ) % 3. After
+    // slice u is smoothed the output of slice u - 1 is computed.
+    for ( IndexValueType u = zBegin - 1; u <= zEnd; ++u )
+      {
+      if ( u >= sliceFirst && u <= sliceLast )
+        {
+        // smooth the lines of the slice along direction 0
+        typename TImage::RegionType lineRegion = tileRegion;
+        lineRegion.SetSize( 0, 1 );
+        lineRegion.SetIndex( R, u );
+        lineRegion.SetSize( R, 1 );
+
+        RealType *out = &sliceBuffer[ ( ( u - zBegin + 1 ) % 3 ) * sliceSize ];
+
+        ImageRegionConstIteratorWithIndex< TImage > lit( input, lineRegion );
+        for ( lit.GoToBegin(); !lit.IsAtEnd(); ++lit, out += ln )
+          {
+          const ImagePixelType *in = input->GetBufferPointer() + input->ComputeOffset( lit.GetIndex() );
+          for ( SizeValueType i = 0; i < ln; ++i )
+            {
+            inputLine[i] = static_cast< RealType >( in[i] );
+            }
+          m_LineKernel->FilterLine( out, &inputLine[0], &scratch[0], ln );
+          }
+        }
+
+      const IndexValueType z = u - 1;
+      if ( z < zBegin )
+        {
+        continue;
+        }
+
+      const RealType *cur = &sliceBuffer[ ( ( z - zBegin + 1 ) % 3 ) * sliceSize ];
+      const RealType *prev = ( z > sliceFirst ) ? &sliceBuffer[ ( ( z - zBegin ) % 3 ) * sliceSize ] : cur;
+      const RealType *next = ( z < sliceLast ) ? &sliceBuffer[ ( ( z - zBegin + 2 ) % 3 ) * sliceSize ] : cur;
+
+      // the neighbors along the last direction are in the other cached
+      // slices
+      OffsetValueType minus[ImageDimension];
+      OffsetValueType plus[ImageDimension];
+      minus[R] = prev - cur;
+      plus[R] = next - cur;
+
+      OutputImageRegionType outputLineRegion = blockRegion;
+      outputLineRegion.SetSize( 0, 1 );
+      outputLineRegion.SetIndex( R, z );
+      outputLineRegion.SetSize( R, 1 );
+
+      ImageRegionIteratorWithIndex< OutputImageType > oit( output, outputLineRegion );
+      for ( oit.GoToBegin(); !oit.IsAtEnd(); ++oit )
+        {
+        const typename OutputImageType::IndexType &idx = oit.GetIndex();
+
+        // offset of the line in the slice, and the offsets to the
+        // neighbors, which are zero at the boundary
+        OffsetValueType lineOffset = 0;
+        for ( unsigned int k = 1; k < R; ++k )
+          {
+          const IndexValueType t = idx[k] - tileRegion.GetIndex( k );
+          lineOffset += t * sliceStride[k];
+          minus[k] = ( t > 0 ) ? -sliceStride[k] : 0;
+          plus[k] = ( t + 1 < static_cast< IndexValueType >( tileRegion.GetSize( k ) ) ) ? sliceStride[k] : 0;
+          }
+
+        OffsetValueType outputOffset = output->ComputeOffset( idx );
+
+        const IndexValueType xEnd = idx[0] + static_cast< IndexValueType >( blockRegion.GetSize( 0 ) ) - lineStart;
+        for ( IndexValueType x = idx[0] - lineStart; x < xEnd; ++x, ++outputOffset )
+          {
+          minus[0] = ( x > 0 ) ? -1 : 0;
+          plus[0] = ( x + 1 < static_cast< IndexValueType >( ln ) ) ? 1 : 0;
+
+          // symetric hessian
+          TensorType H;
+          stencil.Evaluate( cur + lineOffset + x, minus, plus, H );
+
+          OutputPixelTraitsType::Assign( H, outputs, outputOffset );
+
+          if ( progress )
+            {
+            progress->CompletedPixel();
+            }
+          }
+        }
+      }
+    }
+
+  return ( inputLine.capacity() + scratch.capacity() + sliceBuffer.capacity() ) * sizeof( RealType );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "Sigma: " << m_Sigma << std::endl;
+  os << "Scale: " << m_Scale << std::endl;
+  os << "ComponentWeights: " << m_ComponentWeights << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkFusedHessianRecursiveGaussianImageFilter_hxx
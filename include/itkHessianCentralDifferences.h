@@ -0,0 +1,189 @@
+#ifndef __itkHessianCentralDifferences_h
+#define __itkHessianCentralDifferences_h
+
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkFixedArray.h"
+#include "itkIntTypes.h"
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class HessianCentralDifferences
+ * \brief The central difference stencil of the Hessian filters and
+ * functions of this module.
+ *
+ * The components of the Hessian of a pixel v are
+ *
+ *   H(i,i) = ( v[+i] + v[-i] - 2 v ) * scale * w_ii / s_i^2
+ *   H(i,j) = ( v[-i-j] - v[-i+j] - v[+i-j] + v[+i+j] ) * scale * w_ij / ( 4 s_i s_j )
+ *
+ * where s is the spacing, scale multiplies all of the components, such
+ * as sigma^2 for the normalization across scale, and w is the weight
+ * of each component. The factors are computed once by SetFactors.
+ *
+ * The neighbors of a pixel along direction i are at the signed buffer
+ * offsets minus[i] and plus[i]. At the boundary the offset is 0, so
+ * that the neighbor outside of the image is the pixel itself, as with
+ * the ZeroFluxNeumannBoundaryCondition.
+ *
+ * The components are numbered in the order of the
+ * SymmetricSecondRankTensor.
+ *
+ * \ingroup ITKDiscreteHessian
+ */
+template< unsigned int VDimension, typename TRealType = double >
+class HessianCentralDifferences
+{
+public:
+  typedef TRealType RealType;
+
+  itkStaticConstMacro( Dimension, unsigned int, VDimension );
+  itkStaticConstMacro( NumberOfComponents, unsigned int, VDimension * ( VDimension + 1 ) / 2 );
+
+  typedef SymmetricSecondRankTensor< RealType, VDimension > TensorType;
+
+  /** Type of the weights of the components, in the order of the
+   * SymmetricSecondRankTensor */
+  typedef FixedArray< double, VDimension * ( VDimension + 1 ) / 2 > ComponentWeightsType;
+
+  HessianCentralDifferences()
+  {
+    ComponentWeightsType weights;
+    weights.Fill( 1.0 );
+    FixedArray< double, VDimension > spacing;
+    spacing.Fill( 1.0 );
+    this->SetFactors( spacing, 1.0, weights );
+  }
+
+  /** Compute the reciprocal of the denominators, times the scale and
+   * the weight of each component. */
+  template< typename TSpacing >
+  void SetFactors( const TSpacing & spacing, double scale, const ComponentWeightsType & weights )
+  {
+    unsigned int k = 0;
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      m_DiagonalFactor[i] = scale * weights[k++] / ( spacing[i] * spacing[i] );
+      for ( unsigned int j = i + 1; j < VDimension; ++j )
+        {
+        m_OffDiagonalFactor[i][j] = scale * weights[k++] / ( 4.0 * spacing[i] * spacing[j] );
+        }
+      }
+  }
+
+  /** Same with a weight of 1 for all of the components */
+  template< typename TSpacing >
+  void SetFactors( const TSpacing & spacing, double scale )
+  {
+    ComponentWeightsType weights;
+    weights.Fill( 1.0 );
+    this->SetFactors( spacing, scale, weights );
+  }
+
+  /** Compute the Hessian of the pixel p */
+  template< typename TPixel >
+  void Evaluate( const TPixel *p,
+                 const OffsetValueType *minus,
+                 const OffsetValueType *plus,
+                 TensorType & H ) const
+  {
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      const OffsetValueType mi = minus[i];
+      const OffsetValueType pi = plus[i];
+
+      //Calculate 2nd order derivative on the diaganal
+      H(i,i) = ( static_cast< RealType >( p[pi] ) + p[mi] - 2.0 * p[0] ) * m_DiagonalFactor[i];
+
+      //Calculate the 2nd derivatives
+      for ( unsigned int j = i + 1; j < VDimension; ++j )
+        {
+        const OffsetValueType mj = minus[j];
+        const OffsetValueType pj = plus[j];
+        H(i,j) = ( static_cast< RealType >( p[mi + mj] )
+                   - p[mi + pj]
+                   - p[pi + mj]
+                   + p[pi + pj] ) * m_OffDiagonalFactor[i][j];
+        }
+      }
+  }
+
+  /** Compute the components of the pixels x = begin to end - 1 of a
+   * line starting at p, whose neighbors are at the same offsets.
+   * Component k of pixel x is components[k * componentStride + x], so
+   * that each loop runs along the line and may be vectorized. */
+  template< typename TPixel >
+  void EvaluateLine( const TPixel *p,
+                     OffsetValueType begin,
+                     OffsetValueType end,
+                     const OffsetValueType *minus,
+                     const OffsetValueType *plus,
+                     RealType *components,
+                     SizeValueType componentStride ) const
+  {
+    RealType *d = components;
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      const OffsetValueType mi = minus[i];
+      const OffsetValueType pi = plus[i];
+
+      //Calculate 2nd order derivative on the diaganal
+      const RealType di = m_DiagonalFactor[i];
+      for ( OffsetValueType x = begin; x < end; ++x )
+        {
+        d[x] = ( static_cast< RealType >( p[x + pi] ) + p[x + mi] - 2.0 * p[x] ) * di;
+        }
+      d += componentStride;
+
+      //Calculate the 2nd derivatives
+      for ( unsigned int j = i + 1; j < VDimension; ++j )
+        {
+        const OffsetValueType mj = minus[j];
+        const OffsetValueType pj = plus[j];
+        const RealType        dij = m_OffDiagonalFactor[i][j];
+        for ( OffsetValueType x = begin; x < end; ++x )
+          {
+          d[x] = ( static_cast< RealType >( p[x + mi + mj] )
+                   - p[x + mi + pj]
+                   - p[x + pi + mj]
+                   + p[x + pi + pj] ) * dij;
+          }
+        d += componentStride;
+        }
+      }
+  }
+
+  /** Compute the components of a whole line of ln pixels along
+   * direction 0, with the boundary at both of its ends. The offsets
+   * along direction 0 are set here. */
+  template< typename TPixel >
+  void EvaluateLine( const TPixel *p,
+                     OffsetValueType ln,
+                     OffsetValueType *minus,
+                     OffsetValueType *plus,
+                     RealType *components ) const
+  {
+    minus[0] = 0;
+    plus[0] = ( ln > 1 ) ? 1 : 0;
+    this->EvaluateLine( p, 0, 1, minus, plus, components, ln );
+    if ( ln > 1 )
+      {
+      minus[0] = -1;
+      this->EvaluateLine( p, 1, ln - 1, minus, plus, components, ln );
+      plus[0] = 0;
+      this->EvaluateLine( p, ln - 1, ln, minus, plus, components, ln );
+      }
+  }
+
+private:
+  RealType m_DiagonalFactor[VDimension];
+  RealType m_OffDiagonalFactor[VDimension][VDimension];
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkHessianCentralDifferences_h
@@ -4,6 +4,8 @@
 #include "itkImageToImageFilter.h"
 #include "itkSymmetricSecondRankTensor.h"
 #include "itkPixelTraits.h"
+#include "itkHessianOutputPixelTraits.h"
+#include "itkHessianPipelineReport.h"
 
 
 namespace itk
@@ -22,7 +24,25 @@ namespace Local
  *
  * The additional feature added is the normalization across scale.
  *
- * THIS FILTER IS NOT IMPLEMENTED WITH DISCRETE GAUSSIAN FILTER YET
+ * The Gaussian kernel is sampled and truncated so that its support
+ * is bounded, as controlled by MaximumError and MaximumKernelWidth.
+ * The input requested region is therefore only the output requested
+ * region padded by the radius of the kernel and of the central
+ * differences, and the filter may be streamed, or applied to a small
+ * region of interest, without processing the whole input. For large
+ * sigmas, the DiscreteHessianRecursiveGaussianImageFilter is faster.
+ *
+ * The output pixel types are those of the HessianImageFilter,
+ * including fixed-point integers scaled by OutputScale and one scalar
+ * output per component.
+ *
+ * \sa HessianOutputPixelTraits
+ *
+ * After an update, GetReport returns the time and memory of the
+ * Gaussian and of the central differences.
+ * \sa HessianPipelineReport
+ * \sa DiscreteGaussianImageFilter
+ * \sa DiscreteHessianRecursiveGaussianImageFilter
  *
  * \ingroup GradientFilters
  * \ingroup Streamed
@@ -32,7 +52,9 @@ template< typename TInputImage,
           typename TOutputImage = Image< SymmetricSecondRankTensor<
                                            typename NumericTraits< typename TInputImage::PixelType >::RealType,
                                            TInputImage::ImageDimension >,
-                                         TInputImage::ImageDimension > >
+                                         TInputImage::ImageDimension >,
+          typename TInternalRealType = typename NumericTraits<
+                                         typename PixelTraits< typename TOutputImage::PixelType >::ValueType >::FloatType >
 class ITK_EXPORT HessianDiscreteGaussianImageFilter:
   public ImageToImageFilter< TInputImage, TOutputImage >
 {
@@ -55,6 +77,13 @@ public:
   typedef TOutputImage                                       OutputImageType;
   typedef typename          OutputImageType::PixelType       OutputPixelType;
   typedef typename PixelTraits< OutputPixelType >::ValueType OutputComponentType;
+  typedef HessianOutputPixelTraits< OutputPixelType, ImageDimension > OutputPixelTraitsType;
+
+  /** Type of the intermediate smoothed images. By default it is the
+   * floating point type of the output components, so that a float
+   * output does not require double precision intermediate images. */
+  typedef TInternalRealType                          InternalRealType;
+  typedef Image< InternalRealType, ImageDimension >  RealImageType;
 
   /** Run-time type information (and related methods).   */
   itkTypeMacro(HessianDiscreteGaussianImageFilter, ImageToImageFilter);
@@ -74,10 +103,38 @@ public:
   itkGetConstMacro( NormalizeAcrossScale, bool );
   itkBooleanMacro( NormalizeAcrossScale );
 
-  /** HessianDiscreteGaussianImageFilter needs all of the input to produce an
-   * output. Therefore, HessianDiscreteGaussianImageFilter needs to provide
-   * an implementation for GenerateInputRequestedRegion in order to inform
-   * the pipeline execution model.
+  /** Set the factor by which the components are multiplied, in
+   * addition to the normalization across scale. Default is 1.
+   * \sa DiscreteHessianRecursiveGaussianImageFilter::SetOutputScale */
+  itkSetMacro( OutputScale, double );
+  itkGetConstMacro( OutputScale, double );
+
+  /** The maximum error of the truncated Gaussian kernel, between 0
+   * and 1. Default is 0.01.
+   * \sa DiscreteGaussianImageFilter::SetMaximumError */
+  itkSetClampMacro( MaximumError, double, 0.00001, 0.99999 );
+  itkGetConstMacro( MaximumError, double );
+
+  /** The maximum width of the Gaussian kernel. If the kernel needed
+   * for MaximumError is wider, it is truncated. Default is 32.
+   * \sa DiscreteGaussianImageFilter::SetMaximumKernelWidth */
+  itkSetMacro( MaximumKernelWidth, unsigned int );
+  itkGetConstMacro( MaximumKernelWidth, unsigned int );
+
+  /** Get the measurements of the internal filters of the last update */
+  const HessianPipelineReport & GetReport() const
+  {
+    return m_Report;
+  }
+
+  /** Set a file to which the report of each update is appended, as a
+   * JSON object per line. Default is empty, no file is written.
+   * \sa DiscreteHessianRecursiveGaussianImageFilter::SetReportFileName */
+  itkSetStringMacro( ReportFileName );
+  itkGetStringMacro( ReportFileName );
+
+  /** The input requested region is the output requested region padded
+   * by the radius of the Gaussian kernel plus one.
    * \sa ImageToImageFilter::GenerateInputRequestedRegion() */
   virtual void GenerateInputRequestedRegion()
   throw( InvalidRequestedRegionError );
@@ -104,9 +161,19 @@ private:
   HessianDiscreteGaussianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                      //purposely not implemented
 
+  /** Get the radius of the input needed for each output pixel */
+  typename InputImageType::SizeType GetInputRadius() const;
+
   /** Normalize the image across scale space */
   bool m_NormalizeAcrossScale;
   double m_Sigma;
+  double m_OutputScale;
+
+  double       m_MaximumError;
+  unsigned int m_MaximumKernelWidth;
+
+  HessianPipelineReport m_Report;
+  std::string           m_ReportFileName;
 };
 
 
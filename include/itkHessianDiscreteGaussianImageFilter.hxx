@@ -2,7 +2,13 @@
 #define __itkHessianDiscreteGaussianImageFilter_txx
 
 #include "itkHessianDiscreteGaussianImageFilter.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkGaussianOperator.h"
 #include "itkHessianImageFilter.h"
+#include "itkProgressAccumulator.h"
+#include "itkMetaDataObject.h"
+
+
 namespace itk
 {
 namespace Local
@@ -11,17 +17,52 @@ namespace Local
 /**
  * Constructor
  */
-template< typename TInputImage, typename TOutputImage >
-HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::HessianDiscreteGaussianImageFilter()
 {
   m_NormalizeAcrossScale = false;
   m_Sigma = 1.0;
+  m_OutputScale = 1.0;
+  m_MaximumError = 0.01;
+  m_MaximumKernelWidth = 32;
+
+  // one output per component for the structure of arrays layout
+  this->SetNumberOfRequiredOutputs( OutputPixelTraitsType::NumberOfOutputs );
+  for ( unsigned int k = 1; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+    }
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+typename HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >::InputImageType::SizeType
+HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GetInputRadius() const
+{
+  const typename InputImageType::SpacingType &spacing = this->GetInput()->GetSpacing();
+
+  // build the same kernels as the DiscreteGaussianImageFilter
+  typename InputImageType::SizeType radius;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    GaussianOperator< InternalRealType, ImageDimension > oper;
+    oper.SetDirection( i );
+    oper.SetVariance( m_Sigma * m_Sigma / ( spacing[i] * spacing[i] ) );
+    oper.SetMaximumError( m_MaximumError );
+    oper.SetMaximumKernelWidth( m_MaximumKernelWidth );
+    oper.CreateDirectional();
+
+    // plus the radius of the central differences
+    radius[i] = oper.GetRadius( i ) + 1;
+    }
+
+  return radius;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::GenerateInputRequestedRegion()
   throw( InvalidRequestedRegionError )
 {
@@ -29,102 +70,126 @@ HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage >
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
   typename InputImageType::Pointer image = const_cast< InputImageType * >( this->GetInput() );
 
-  if ( image )
+  if ( !image )
+    {
+    return;
+    }
+
+  typename InputImageType::RegionType inputRequestedRegion = image->GetRequestedRegion();
+  inputRequestedRegion.PadByRadius( this->GetInputRadius() );
+
+  // crop the input requested region at the input's largest possible region
+  if ( inputRequestedRegion.Crop( image->GetLargestPossibleRegion() ) )
     {
-    image->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
+    image->SetRequestedRegion( inputRequestedRegion );
+    return;
     }
+
+  // store what we tried to request (prior to trying to crop)
+  image->SetRequestedRegion( inputRequestedRegion );
+
+  InvalidRequestedRegionError e(__FILE__, __LINE__);
+  e.SetLocation(ITK_LOCATION);
+  e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+  e.SetDataObject(image);
+  throw e;
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::GenerateData(void)
 {
   itkDebugMacro(<< "HessianDiscreteGaussianImageFilter generating data ");
 
+  // record the scale of the stored components, so that an integer
+  // output can be decoded
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    EncapsulateMetaData< double >( this->GetOutput( k )->GetMetaDataDictionary(),
+                                   HessianOutputScaleKey(), this->m_OutputScale );
+    }
+
   // Create a process accumulator for tracking the progress of this
   // minipipeline
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
 
 
   // Get the input and output pointers
   typename InputImageType::ConstPointer  input = this->GetInput();
-  typename OutputImageType::Pointer      output = this->GetOutput();
-
 
-  typedef itk::Image< double, ImageDimension> RealImageType;
-  typedef itk::RecursiveGaussianImageFilter< InputImageType, RealImageType > FirstGaussianFilterType;
-  typedef itk::RecursiveGaussianImageFilter< RealImageType, RealImageType > RealGaussianFilterType;
-
-  // The first Gaussian filter in the mini pipeline
-  //
-  // Convert the input to the real pixel type,
-  // Do not perform operation in-place as not to steal input data
-  typename FirstGaussianFilterType::Pointer firstGaussian = FirstGaussianFilterType::New();
-  firstGaussian->SetOrder( FirstGaussianFilterType::ZeroOrder );
-  firstGaussian->SetNormalizeAcrossScale( false );
-  firstGaussian->SetSigma( this->m_Sigma );
-  firstGaussian->SetDirection( ImageDimension - 1 );
-  firstGaussian->InPlaceOff();
-  firstGaussian->ReleaseDataFlagOn();
-  firstGaussian->SetInput( input );
-
-  progress->RegisterInternalFilter( firstGaussian,  1.0/(ImageDimension+1) );
-
-
-  // Assemble remaining gaussian filters
-  // All are inplace and real image to real image
-  typename RealGaussianFilterType::Pointer gaussianFilters[ImageDimension - 1];
-  for( unsigned int i = 0; i < ImageDimension-1; ++i )
+  // measure the internal filters, the progress weights are from the
+  // measurements of the previous run
+  m_Report.Start( this->GetNameOfClass(), 2 );
+
+  // The separable discrete Gaussian converts the input to the real
+  // pixel type. It only requests the padded region of its input.
+  typedef itk::DiscreteGaussianImageFilter< InputImageType, RealImageType > GaussianFilterType;
+  typename GaussianFilterType::Pointer gaussian = GaussianFilterType::New();
+  gaussian->SetInput( input );
+  gaussian->SetVariance( m_Sigma * m_Sigma );
+  gaussian->SetMaximumError( m_MaximumError );
+  gaussian->SetMaximumKernelWidth( m_MaximumKernelWidth );
+  gaussian->SetUseImageSpacing( true );
+  gaussian->ReleaseDataFlagOn();
+
+  progress->RegisterInternalFilter( gaussian,
+                                    m_Report.AddStage( gaussian.GetPointer(), "DiscreteGaussianImageFilter",
+                                                       double( ImageDimension )/(ImageDimension+1) ) );
+
+  typedef itk::Local::HessianImageFilter< RealImageType, OutputImageType > HessianFilterType;
+  typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussian->GetOutput() );
+
+  // the normalization across scale is applied by the central
+  // differences
+  double scale = this->m_OutputScale;
+  if ( this->m_NormalizeAcrossScale )
     {
-    gaussianFilters[i] = RealGaussianFilterType::New();
-    if ( i == 0 )
-      {
-      gaussianFilters[i]->SetInput( firstGaussian->GetOutput() );
-      }
-    else
-      {
-      gaussianFilters[i]->SetInput( gaussianFilters[i-1]->GetOutput() );
-      }
-    gaussianFilters[i]->SetOrder( RealGaussianFilterType::ZeroOrder );
-    gaussianFilters[i]->SetNormalizeAcrossScale( false );
-    gaussianFilters[i]->SetSigma( this->m_Sigma );
-    gaussianFilters[i]->SetDirection( ImageDimension-i-2 );
-    gaussianFilters[i]->InPlaceOn();
-    gaussianFilters[i]->ReleaseDataFlagOn();
-
-    progress->RegisterInternalFilter( gaussianFilters[i],  1.0/(ImageDimension+1) );
+    scale *= vnl_math_sqr( this->m_Sigma );
     }
+  hessian->SetScale( scale );
 
-
-  typedef itk::Local::HessianImageFilter<RealImageType, OutputImageType> HessianImageFilterType;
-  typename HessianImageFilterType::Pointer hessian = HessianImageFilterType::New();
-  hessian->SetInput( gaussianFilters[ ImageDimension - 2 ]->GetOutput() );
-
-  progress->RegisterInternalFilter( hessian, 1.0/(ImageDimension+1) );
+  progress->RegisterInternalFilter( hessian,
+                                    m_Report.AddStage( hessian.GetPointer(), "HessianImageFilter", 1.0/(ImageDimension+1) ) );
 
   // Perform standard graft-update-graft
   //
   // This saves memory, and copies the requested region to the filter
   // so that hessian filter updates the correct region
-  hessian->GraftOutput( output );
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    hessian->GraftNthOutput( k, this->GetOutput( k ) );
+    }
   hessian->Update();
-  this->GraftOutput( hessian->GetOutput() );
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->GraftNthOutput( k, hessian->GetOutput( k ) );
+    }
+
+  m_Report.Finish( this->GetOutput()->GetRequestedRegion().GetNumberOfPixels(), this->GetNumberOfThreads() );
+
+  if ( !m_ReportFileName.empty() )
+    {
+    m_Report.AppendJSON( m_ReportFileName );
+    }
 }
 
-template< typename TInputImage, typename TOutputImage >
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
 void
-HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
   os << "Sigma: " << m_Sigma << std::endl;
+  os << "OutputScale: " << m_OutputScale << std::endl;
+  os << "MaximumError: " << m_MaximumError << std::endl;
+  os << "MaximumKernelWidth: " << m_MaximumKernelWidth << std::endl;
+  os << "ReportFileName: " << m_ReportFileName << std::endl;
 }
 
 } // end namespace Local
@@ -4,6 +4,9 @@
 #include "itkImage.h"
 #include "itkImageToImageFilter.h"
 #include "itkSymmetricSecondRankTensor.h"
+#include "itkProgressReporter.h"
+#include "itkHessianOutputPixelTraits.h"
+#include "itkHessianCentralDifferences.h"
 
 namespace itk
 {
@@ -14,6 +17,25 @@ namespace Local
  * \class HessianImageFilter
  * \brief Computes the Hessian matrix by central differences
  *
+ * The interior of the image, where no boundary condition is needed,
+ * is processed a scanline at a time with precomputed buffer offsets,
+ * each Hessian component being computed for a whole scanline so
+ * that the loops may be vectorized. Only the boundary faces use a
+ * neighborhood iterator.
+ *
+ * The output pixel may be a SymmetricSecondRankTensor, or a FixedArray
+ * of the eigenvalues, with or without the eigenvectors, which are
+ * then computed per pixel as the Hessian is computed.
+ * The components may also be stored as float or as fixed-point
+ * integers, or in a structure of arrays layout where the filter has
+ * one scalar output image per component.
+ * \sa HessianOutputPixelTraits
+ *
+ * The components may be multiplied by a Scale, such as sigma^2 for
+ * the normalization across scale, and by a weight per component. The
+ * factors are folded with the spacing into the central differences,
+ * so they do not cost an additional pass over the output.
+ *
  * \ingroup GradientFilters
  * \ingroup Streamed
  * \ingroup ITKDiscreteHessian
@@ -38,12 +60,25 @@ public:
   /** Pixel Type of the input image */
   typedef TInputImage                                    InputImageType;
   typedef typename InputImageType::PixelType             PixelType;
+  typedef typename NumericTraits< PixelType >::RealType  RealType;
 
   /** Type of the output Image */
   typedef TOutputImage                                      OutputImageType;
   typedef typename          OutputImageType::PixelType      OutputPixelType;
   typedef typename OutputImageType::RegionType              OutputImageRegionType;
 
+  /** Type of the Hessian computed per pixel, before it is converted
+   * to the output pixel */
+  typedef SymmetricSecondRankTensor< RealType, TInputImage::ImageDimension > TensorType;
+  typedef HessianOutputPixelTraits< OutputPixelType, TInputImage::ImageDimension > OutputPixelTraitsType;
+
+  /** Type of the weights of the components of the Hessian, in the
+   * order of the SymmetricSecondRankTensor */
+  typedef FixedArray< double, TInputImage::ImageDimension * ( TInputImage::ImageDimension + 1 ) / 2 > ComponentWeightsType;
+
+  /** Type of the central difference stencil */
+  typedef HessianCentralDifferences< TInputImage::ImageDimension, RealType > StencilType;
+
 
  /** Run-time type information (and related methods).   */
   itkTypeMacro( HessianImageFilter, ImageToImageFilter );
@@ -51,6 +86,16 @@ public:
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
+  /** Set the factor by which all of the components are multiplied.
+   * Default is 1. */
+  itkSetMacro( Scale, double );
+  itkGetConstMacro( Scale, double );
+
+  /** Set the factor by which each component is multiplied. Default
+   * is 1 for all components. */
+  itkSetMacro( ComponentWeights, ComponentWeightsType );
+  itkGetConstReferenceMacro( ComponentWeights, ComponentWeightsType );
+
   virtual void GenerateInputRequestedRegion()
     throw( InvalidRequestedRegionError );
 
@@ -67,15 +112,24 @@ public:
 protected:
 
   HessianImageFilter( void );
+  void PrintSelf(std::ostream & os, Indent indent) const;
 
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
 
+  /** Process a region which does not need a boundary condition */
+  void ThreadedGenerateDataInterior(const OutputImageRegionType& interiorRegion,
+                                    OutputPixelType * const *outputs,
+                                    const StencilType & stencil,
+                                    ProgressReporter &progress);
+
 
 private:
 
   HessianImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
+  double               m_Scale;
+  ComponentWeightsType m_ComponentWeights;
 };
 
 } // end namepace Local
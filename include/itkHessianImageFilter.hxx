@@ -6,11 +6,14 @@
 
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNeighborhoodAlgorithm.h"
 
 #include "itkProgressReporter.h"
 #include "itkProgressAccumulator.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace Local
@@ -24,6 +27,15 @@ template <typename TInputImage, typename TOutputImage >
 HessianImageFilter<TInputImage,TOutputImage>
 ::HessianImageFilter( void )
 {
+  m_Scale = 1.0;
+  m_ComponentWeights.Fill( 1.0 );
+
+  // one output per component for the structure of arrays layout
+  this->SetNumberOfRequiredOutputs( OutputPixelTraitsType::NumberOfOutputs );
+  for ( unsigned int k = 1; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    this->SetNthOutput( k, this->MakeOutput( k ) );
+    }
 }
 
 /**
@@ -100,16 +112,17 @@ HessianImageFilter<TInputImage,TOutputImage>
 
   TOutputImage *output = this->GetOutput();
 
-
-  typedef typename OutputImageType::PixelType HessianType;
-  ImageRegionIterator<OutputImageType> oit;
+  // the outputs have the same buffered region
+  OutputPixelType *outputs[OutputPixelTraitsType::NumberOfOutputs];
+  for ( unsigned int k = 0; k < OutputPixelTraitsType::NumberOfOutputs; ++k )
+    {
+    outputs[k] = this->GetOutput( k )->GetBufferPointer();
+    }
 
   itk::Size<ImageDimension> radius;
   radius.Fill( 1 );
-  unsigned long center;
-  unsigned long stride[ImageDimension];
-
-  typename TInputImage::SpacingType spacing = input->GetSpacing();
+  StencilType stencil;
+  stencil.SetFactors( input->GetSpacing(), m_Scale, m_ComponentWeights );
 
 
   // compute the boundary faces of our region
@@ -119,62 +132,130 @@ HessianImageFilter<TInputImage,TOutputImage>
 
   typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< TInputImage >::FaceListType::iterator fit;
 
+  // the first face is the interior region, where no boundary
+  // condition is needed
+  fit = faceList.begin();
+  typename TInputImage::RegionType paddedInterior = *fit;
+  paddedInterior.PadByRadius( radius );
+  if ( fit->GetNumberOfPixels() > 0 && input->GetBufferedRegion().IsInside( paddedInterior ) )
+    {
+    this->ThreadedGenerateDataInterior( *fit, outputs, stencil, progress );
+    ++fit;
+    }
+
   typedef ConstNeighborhoodIterator< TInputImage > NeighborhoodType;
 
-  // get center and dimension strides for iterator neighborhoods
+  // get center and dimension strides for iterator neighborhoods, the
+  // neighborhood is copied to apply the stencil
   NeighborhoodType it( radius, input, *faceList.begin() );
-  center = it.Size()/2;
+  const OffsetValueType center = it.Size()/2;
+  OffsetValueType minus[ImageDimension];
+  OffsetValueType plus[ImageDimension];
   for ( unsigned int i = 0; i < ImageDimension; ++i )
     {
-    stride[i] = it.GetStride(i);
+    minus[i] = -static_cast< OffsetValueType >( it.GetStride(i) );
+    plus[i] = it.GetStride(i);
     }
+  std::vector< RealType > neighborhood( it.Size() );
 
-  // process each of the region "faces"
-  for ( fit = faceList.begin(); fit != faceList.end(); ++fit )
+  // process each of the remaining boundary "faces"
+  for ( ; fit != faceList.end(); ++fit )
     {
     // set up the iterator for the "face" and let the automatic
     // boundary condition detection work as needed
     it = NeighborhoodType( radius, input, *fit);
 
-    oit = ImageRegionIterator<OutputImageType>( output, *fit );
-
     while ( !it.IsAtEnd() )
       {
-      // symetric hessian
-      HessianType H;
-
-
-      //Calculate 2nd order derivative on the diaganal
-      for ( unsigned int i = 0; i < ImageDimension; i++ )
+      for ( unsigned int n = 0; n < neighborhood.size(); ++n )
         {
-        H(i,i) = it.GetPixel(center + stride[i]) + it.GetPixel(center - stride[i])
-          - 2.0 * it.GetPixel(center);
-        H(i,i) /= spacing[i] * spacing[i];
+        neighborhood[n] = static_cast< RealType >( it.GetPixel(n) );
         }
 
-      //Calculate the 2nd derivatives
-      for ( unsigned int i = 0; i < ImageDimension - 1; i++ )
-        {
-        for ( unsigned int j = i + 1; j < ImageDimension; j++ )
-          {
-          H(i,j) = it.GetPixel(center - stride[i] - stride[j])
-            - it.GetPixel(center - stride[i] + stride[j])
-            - it.GetPixel(center + stride[i] - stride[j])
-            + it.GetPixel(center + stride[i] + stride[j]);
-          H(i,j) /= 4.0 * spacing[i] * spacing[j];
-          }
-        }
+      // symetric hessian
+      TensorType H;
+      stencil.Evaluate( &neighborhood[center], minus, plus, H );
 
-      oit.Set( H );
+      OutputPixelTraitsType::Assign( H, outputs, output->ComputeOffset( it.GetIndex() ) );
 
-      ++oit;
       ++it;
-       progress.CompletedPixel();
+      progress.CompletedPixel();
       }
     }
 
 }
 
+/**
+ * Scanline processing of the interior face
+ */
+template <typename TInputImage, typename TOutputImage >
+void
+HessianImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateDataInterior(const OutputImageRegionType& interiorRegion,
+                               OutputPixelType * const *outputs,
+                               const StencilType & stencil,
+                               ProgressReporter &progress)
+{
+  const unsigned int ImageDimension = TInputImage::ImageDimension;
+  const unsigned int NumberOfComponents = ImageDimension * ( ImageDimension + 1 ) / 2;
+
+  const TInputImage *input = this->GetInput();
+  TOutputImage      *output = this->GetOutput();
+
+  // strides of the input buffer, all neighbors are inside the buffer
+  const OffsetValueType *inputStride = input->GetOffsetTable();
+
+  OffsetValueType minus[ImageDimension];
+  OffsetValueType plus[ImageDimension];
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    minus[i] = -inputStride[i];
+    plus[i] = inputStride[i];
+    }
+
+  // signed, so that the neighbors of the loops are computed in signed
+  // arithmetic
+  const OffsetValueType ln = static_cast< OffsetValueType >( interiorRegion.GetSize( 0 ) );
+
+  // the components of a scanline are computed into contiguous
+  // buffers, so that the loops are vectorized across voxels
+  std::vector< RealType > componentBuffer( NumberOfComponents * ln );
+
+  OutputImageRegionType lineRegion = interiorRegion;
+  lineRegion.SetSize( 0, 1 );
+
+  ImageRegionConstIteratorWithIndex< TInputImage > lit( input, lineRegion );
+  for ( lit.GoToBegin(); !lit.IsAtEnd(); ++lit )
+    {
+    const PixelType *in = input->GetBufferPointer() + input->ComputeOffset( lit.GetIndex() );
+    const OffsetValueType outputOffset = output->ComputeOffset( lit.GetIndex() );
+
+    stencil.EvaluateLine( in, 0, ln, minus, plus, &componentBuffer[0], ln );
+
+    // interleave the components into the output pixels
+    for ( OffsetValueType x = 0; x < ln; ++x )
+      {
+      TensorType H;
+      const RealType *c = &componentBuffer[x];
+      for ( unsigned int k = 0; k < NumberOfComponents; ++k, c += ln )
+        {
+        H[k] = *c;
+        }
+      OutputPixelTraitsType::Assign( H, outputs, outputOffset + x );
+      progress.CompletedPixel();
+      }
+    }
+}
+
+template <typename TInputImage, typename TOutputImage >
+void
+HessianImageFilter<TInputImage,TOutputImage>
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "Scale: " << m_Scale << std::endl;
+  os << "ComponentWeights: " << m_ComponentWeights << std::endl;
+}
 
 } // end namespace Local
 } // end namespace itk
@@ -0,0 +1,189 @@
+#ifndef __itkHessianOutputPixelTraits_h
+#define __itkHessianOutputPixelTraits_h
+
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkFixedArray.h"
+#include "itkVector.h"
+#include "itkPixelTraits.h"
+#include "itkMath.h"
+
+#include <limits>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class HessianOutputPixelTraits
+ * \brief Converts a computed Hessian to the output pixel type of the
+ * Hessian filters.
+ *
+ * The output pixel type of the filters in this module selects what is
+ * written for each pixel:
+ *
+ * - a SymmetricSecondRankTensor, or a FixedArray or Vector of length
+ *   VDimension*(VDimension+1)/2, receives the components of the
+ *   Hessian.
+ * - a FixedArray or Vector of length VDimension receives the
+ *   eigenvalues of the Hessian in ascending order.
+ * - a FixedArray or Vector of length VDimension*(VDimension+1)
+ *   receives the eigenvalues in ascending order, followed by the
+ *   corresponding unit eigenvectors, one after the other.
+ * - a scalar selects a structure of arrays layout: the filter has
+ *   VDimension*(VDimension+1)/2 outputs, output k holding component k
+ *   of the Hessian, in the order of the SymmetricSecondRankTensor.
+ *
+ * The components may be of any numeric type. Float halves the size of
+ * a double tensor. For an integer type, such as short, the values are
+ * rounded and saturated to the range of the type, so that with the
+ * Scale of the filter set to 1/q the pixels hold a fixed-point
+ * representation of the Hessian with the quantization step q. The
+ * composite filters record their OutputScale in the MetaDataDictionary
+ * of their outputs, under HessianOutputScaleKey(), so that such an
+ * image can be decoded once it is written to disk.
+ *
+ * The eigen-analysis is done in the threaded kernel, so that the
+ * tensor image does not need to be written and read back by a
+ * separate eigen-analysis filter.
+ *
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TOutputPixel, unsigned int VDimension, unsigned int VLength = PixelTraits< TOutputPixel >::Dimension >
+class HessianOutputPixelTraits
+{
+public:
+  typedef TOutputPixel                                     OutputPixelType;
+  typedef typename PixelTraits< TOutputPixel >::ValueType  ValueType;
+
+  /** Select what is stored in a pixel from its length */
+  itkStaticConstMacro( NumberOfComponents, unsigned int, VDimension * ( VDimension + 1 ) / 2 );
+  itkStaticConstMacro( StoresEigenValues, bool, VLength == VDimension && VDimension > 1 );
+  itkStaticConstMacro( StoresEigenVectors, bool, VLength == VDimension * ( VDimension + 1 ) );
+  itkStaticConstMacro( StoresComponentImages, bool, VLength == 1 && VDimension > 1 );
+
+  /** Number of outputs of the filters */
+  itkStaticConstMacro( NumberOfOutputs, unsigned int, StoresComponentImages ? NumberOfComponents : 1 );
+
+  /** Write the Hessian H to the output pixel */
+  template< typename TTensor >
+  static void Assign( const TTensor & H, OutputPixelType & o )
+  {
+    Self::AssignImpl( H, o, Dispatch< StoresEigenValues ? 1 : ( StoresEigenVectors ? 2 : 0 ) >() );
+  }
+
+  /** Write the Hessian H at offset of the buffers of the
+   * NumberOfOutputs outputs, which have the same buffered region */
+  template< typename TTensor >
+  static void Assign( const TTensor & H, OutputPixelType * const *outputs, OffsetValueType offset )
+  {
+    Self::AssignImpl( H, outputs, offset, Dispatch< StoresComponentImages ? 3 : 4 >() );
+  }
+
+  /** Convert a component to the type of the output, rounding and
+   * saturating when it is an integer */
+  template< typename TReal >
+  static ValueType Convert( TReal v )
+  {
+    return Self::ConvertImpl( v, Dispatch< std::numeric_limits< ValueType >::is_integer ? 1 : 0 >() );
+  }
+
+private:
+  typedef HessianOutputPixelTraits Self;
+
+  template< int > struct Dispatch {};
+
+  /** components of the symmetric matrix */
+  template< typename TTensor >
+  static void AssignImpl( const TTensor & H, OutputPixelType & o, Dispatch< 0 > )
+  {
+    // a compile time error if the length of the pixel is not supported
+    typedef char LengthCheckType[ ( VLength == NumberOfComponents ) ? 1 : -1 ];
+    LengthCheckType *lengthCheck = 0;
+    (void) lengthCheck;
+
+    for ( unsigned int i = 0; i < NumberOfComponents; ++i )
+      {
+      o[i] = Self::Convert( H[i] );
+      }
+  }
+
+  /** eigenvalues */
+  template< typename TTensor >
+  static void AssignImpl( const TTensor & H, OutputPixelType & o, Dispatch< 1 > )
+  {
+    typename TTensor::EigenValuesArrayType eigenValues;
+    H.ComputeEigenValues( eigenValues );
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      o[i] = Self::Convert( eigenValues[i] );
+      }
+  }
+
+  /** eigenvalues followed by the eigenvectors */
+  template< typename TTensor >
+  static void AssignImpl( const TTensor & H, OutputPixelType & o, Dispatch< 2 > )
+  {
+    typename TTensor::EigenValuesArrayType   eigenValues;
+    typename TTensor::EigenVectorsMatrixType eigenVectors;
+    H.ComputeEigenAnalysis( eigenValues, eigenVectors );
+    for ( unsigned int i = 0; i < VDimension; ++i )
+      {
+      o[i] = Self::Convert( eigenValues[i] );
+      for ( unsigned int j = 0; j < VDimension; ++j )
+        {
+        o[VDimension + i * VDimension + j] = Self::Convert( eigenVectors(i,j) );
+        }
+      }
+  }
+
+  /** one component per output */
+  template< typename TTensor >
+  static void AssignImpl( const TTensor & H, OutputPixelType * const *outputs, OffsetValueType offset, Dispatch< 3 > )
+  {
+    for ( unsigned int k = 0; k < NumberOfComponents; ++k )
+      {
+      outputs[k][offset] = Self::Convert( H[k] );
+      }
+  }
+
+  /** a single output */
+  template< typename TTensor >
+  static void AssignImpl( const TTensor & H, OutputPixelType * const *outputs, OffsetValueType offset, Dispatch< 4 > )
+  {
+    Self::Assign( H, outputs[0][offset] );
+  }
+
+  template< typename TReal >
+  static ValueType ConvertImpl( TReal v, Dispatch< 0 > )
+  {
+    return static_cast< ValueType >( v );
+  }
+
+  template< typename TReal >
+  static ValueType ConvertImpl( TReal v, Dispatch< 1 > )
+  {
+    if ( v <= static_cast< TReal >( NumericTraits< ValueType >::NonpositiveMin() ) )
+      {
+      return NumericTraits< ValueType >::NonpositiveMin();
+      }
+    if ( v >= static_cast< TReal >( NumericTraits< ValueType >::max() ) )
+      {
+      return NumericTraits< ValueType >::max();
+      }
+    return Math::Round< ValueType >( v );
+  }
+};
+
+/** The key of the entry of the MetaDataDictionary of the outputs of
+ * the composite Hessian filters which holds their OutputScale, as a
+ * double. A stored component divided by it is the Hessian. */
+inline const char * HessianOutputScaleKey()
+{
+  return "HessianOutputScale";
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkHessianOutputPixelTraits_h
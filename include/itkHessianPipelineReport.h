@@ -0,0 +1,371 @@
+#ifndef __itkHessianPipelineReport_h
+#define __itkHessianPipelineReport_h
+
+#include "itkCommand.h"
+#include "itkRealTimeClock.h"
+#include "itkProgressAccumulator.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class HessianPipelineReport
+ * \brief Measures the internal filters of the composite Hessian
+ * filters.
+ *
+ * For each internal filter, or stage, of a run the report records the
+ * wall and CPU time, the bytes of the buffers it allocated, the number
+ * of threads and the output requested region.
+ *
+ * The CPU time is measured with std::clock, which is the CPU time of
+ * the whole process, not of the stage: the CPU time over the wall time
+ * is the number of busy threads of the process. It only measures the
+ * stage when no other pipeline, or other work, runs concurrently in
+ * the process.
+ *
+ * The allocated bytes are those of the outputs of the stage, unless it
+ * runs in place, plus those of the buffers allocated internally by the
+ * filter, such as an intermediate image or the buffers of its threads.
+ * A filter which allocates such buffers overloads
+ * ComputeHessianStageInternalBytes next to its declaration.
+ *
+ * The cost per pixel of each stage may be used to predict the time
+ * and memory of a run on a larger image. The relative wall time of the
+ * stages of a run is also used as the progress weights of the next
+ * run with the same stages.
+ *
+ * A composite filter calls Start, AddStage for each internal filter
+ * before the mini-pipeline is updated, and Finish.
+ *
+ * \ingroup ITKDiscreteHessian
+ */
+class HessianPipelineReport
+{
+public:
+
+  /** The measurements of an internal filter */
+  struct StageType
+  {
+    StageType() :
+      WallTime( 0.0 ), CPUTime( 0.0 ), AllocatedBytes( 0 ), NumberOfThreads( 0 ),
+      ProgressWeight( 0.0 ) {}
+
+    std::string                   Name;
+    double                        WallTime;
+
+    /** The CPU time of the whole process during the stage */
+    double                        CPUTime;
+    SizeValueType                 AllocatedBytes;
+    ThreadIdType                  NumberOfThreads;
+    std::vector< IndexValueType > RegionIndex;
+    std::vector< SizeValueType >  RegionSize;
+
+    double ProgressWeight;
+  };
+
+  typedef std::vector< StageType > StagesType;
+
+  HessianPipelineReport() :
+    m_NumberOfPixels( 0 ), m_NumberOfThreads( 0 ), m_WallTime( 0.0 ), m_CPUTime( 0.0 ),
+    m_WallStart( 0.0 ), m_CPUStart( 0 ), m_ExpectedNumberOfStages( 0 ) {}
+
+  /** Begin a run of a composite filter with the given number of
+   * stages. The stages of the previous run are kept for the progress
+   * weights. */
+  void Start( const std::string & filterName, unsigned int numberOfStages )
+  {
+    m_PreviousStages.swap( m_Stages );
+    m_Stages.clear();
+    m_FilterName = filterName;
+    m_ExpectedNumberOfStages = numberOfStages;
+    m_WallStart = Self::GetClockTime();
+    m_CPUStart = std::clock();
+  }
+
+  /** Observe an internal filter, and return its progress weight: its
+   * relative wall time in the previous run if it had the same stages,
+   * otherwise the given default weight. */
+  template< typename TFilter >
+  double AddStage( TFilter *filter, const std::string & name, double defaultWeight );
+
+  /** Complete the run. The pixels are those of the output requested
+   * region. */
+  void Finish( SizeValueType numberOfPixels, ThreadIdType numberOfThreads )
+  {
+    m_WallTime = Self::GetClockTime() - m_WallStart;
+    m_CPUTime = static_cast< double >( std::clock() - m_CPUStart ) / CLOCKS_PER_SEC;
+    m_NumberOfPixels = numberOfPixels;
+    m_NumberOfThreads = numberOfThreads;
+  }
+
+  const std::string & GetFilterName() const { return m_FilterName; }
+  SizeValueType GetNumberOfPixels() const { return m_NumberOfPixels; }
+  ThreadIdType GetNumberOfThreads() const { return m_NumberOfThreads; }
+  double GetWallTime() const { return m_WallTime; }
+  double GetCPUTime() const { return m_CPUTime; }
+
+  /** The sum of the bytes allocated by the stages */
+  SizeValueType GetAllocatedBytes() const
+  {
+    SizeValueType bytes = 0;
+    for ( unsigned int i = 0; i < m_Stages.size(); ++i )
+      {
+      bytes += m_Stages[i].AllocatedBytes;
+      }
+    return bytes;
+  }
+
+  unsigned int GetNumberOfStages() const { return m_Stages.size(); }
+  const StageType & GetStage( unsigned int i ) const { return m_Stages[i]; }
+  StageType & GetStage( unsigned int i ) { return m_Stages[i]; }
+
+  /** Write the report as a single line JSON object */
+  void WriteJSON( std::ostream & os ) const;
+
+  /** Append the report as a single line JSON object to a file. Throws
+   * an exception if the file cannot be opened. */
+  void AppendJSON( const std::string & fileName ) const;
+
+  /** The current wall clock time in seconds */
+  static double GetClockTime()
+  {
+    RealTimeClock::Pointer clock = RealTimeClock::New();
+    return clock->GetTimeInSeconds();
+  }
+
+private:
+
+  typedef HessianPipelineReport Self;
+
+  template< typename TFilter >
+  class StageObserver;
+
+  StagesType    m_Stages;
+  StagesType    m_PreviousStages;
+  std::string   m_FilterName;
+  SizeValueType m_NumberOfPixels;
+  ThreadIdType  m_NumberOfThreads;
+  double        m_WallTime;
+  double        m_CPUTime;
+  double        m_WallStart;
+  std::clock_t  m_CPUStart;
+  unsigned int  m_ExpectedNumberOfStages;
+};
+
+/** The bytes of the output buffers of a filter */
+template< typename TFilter >
+SizeValueType ComputeHessianStageOutputBytes( const TFilter *filter )
+{
+  SizeValueType bytes = 0;
+  for ( unsigned int k = 0; k < filter->GetNumberOfOutputs(); ++k )
+    {
+    bytes += filter->GetOutput( k )->GetBufferedRegion().GetNumberOfPixels()
+      * sizeof( typename TFilter::OutputImageType::PixelType );
+    }
+  return bytes;
+}
+
+/** The bytes of the buffers allocated by a filter other than its
+ * outputs. Zero by default, a filter which allocates such buffers
+ * overloads this function. */
+template< typename TFilter >
+SizeValueType ComputeHessianStageInternalBytes( const TFilter * )
+{
+  return 0;
+}
+
+/** The bytes of the buffers allocated by a filter, its outputs unless
+ * it runs in place, and its internal buffers */
+template< typename TFilter >
+SizeValueType ComputeHessianStageAllocatedBytes( const TFilter *filter )
+{
+  SizeValueType bytes = ComputeHessianStageInternalBytes( filter );
+  if ( !filter->GetInput()
+       || static_cast< const void * >( filter->GetInput()->GetBufferPointer() )
+          != static_cast< const void * >( filter->GetOutput()->GetBufferPointer() ) )
+    {
+    bytes += ComputeHessianStageOutputBytes( filter );
+    }
+  return bytes;
+}
+
+/**
+ * \class HessianPipelineReport::StageObserver
+ * \brief Records the measurements of a stage on its start and end
+ * events.
+ */
+template< typename TFilter >
+class HessianPipelineReport::StageObserver: public Command
+{
+public:
+  typedef StageObserver        Self;
+  typedef Command              Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  itkTypeMacro(StageObserver, Command);
+
+  itkNewMacro(Self);
+
+  void SetStage( HessianPipelineReport *report, unsigned int stage )
+  {
+    m_Report = report;
+    m_Stage = stage;
+  }
+
+  void Execute( Object *caller, const EventObject & event )
+  {
+    this->Execute( const_cast< const Object * >( caller ), event );
+  }
+
+  void Execute( const Object *caller, const EventObject & event )
+  {
+    if ( StartEvent().CheckEvent( &event ) )
+      {
+      m_WallStart = HessianPipelineReport::GetClockTime();
+      m_CPUStart = std::clock();
+      return;
+      }
+
+    if ( !EndEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+
+    const TFilter *filter = dynamic_cast< const TFilter * >( caller );
+    if ( !filter )
+      {
+      return;
+      }
+
+    StageType & stage = m_Report->GetStage( m_Stage );
+    stage.WallTime = HessianPipelineReport::GetClockTime() - m_WallStart;
+    stage.CPUTime = static_cast< double >( std::clock() - m_CPUStart ) / CLOCKS_PER_SEC;
+    stage.NumberOfThreads = filter->GetNumberOfThreads();
+    stage.AllocatedBytes = ComputeHessianStageAllocatedBytes( filter );
+
+    const typename TFilter::OutputImageType::RegionType & region = filter->GetOutput()->GetRequestedRegion();
+    stage.RegionIndex.resize( TFilter::OutputImageType::ImageDimension );
+    stage.RegionSize.resize( TFilter::OutputImageType::ImageDimension );
+    for ( unsigned int i = 0; i < TFilter::OutputImageType::ImageDimension; ++i )
+      {
+      stage.RegionIndex[i] = region.GetIndex( i );
+      stage.RegionSize[i] = region.GetSize( i );
+      }
+  }
+
+protected:
+  StageObserver() : m_Report( 0 ), m_Stage( 0 ), m_WallStart( 0.0 ), m_CPUStart( 0 ) {}
+
+private:
+  StageObserver(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  HessianPipelineReport *m_Report;
+  unsigned int           m_Stage;
+  double                 m_WallStart;
+  std::clock_t           m_CPUStart;
+};
+
+template< typename TFilter >
+double
+HessianPipelineReport
+::AddStage( TFilter *filter, const std::string & name, double defaultWeight )
+{
+  const unsigned int i = m_Stages.size();
+
+  StageType stage;
+  stage.Name = name;
+  stage.ProgressWeight = defaultWeight;
+
+  // the relative wall time of the same stage in the previous run
+  if ( m_PreviousStages.size() == m_ExpectedNumberOfStages && i < m_PreviousStages.size()
+       && m_PreviousStages[i].Name == name )
+    {
+    double totalWallTime = 0.0;
+    for ( unsigned int k = 0; k < m_PreviousStages.size(); ++k )
+      {
+      totalWallTime += m_PreviousStages[k].WallTime;
+      }
+    if ( totalWallTime > 0.0 )
+      {
+      stage.ProgressWeight = m_PreviousStages[i].WallTime / totalWallTime;
+      }
+    }
+
+  m_Stages.push_back( stage );
+
+  typename StageObserver< TFilter >::Pointer observer = StageObserver< TFilter >::New();
+  observer->SetStage( this, i );
+  filter->AddObserver( StartEvent(), observer );
+  filter->AddObserver( EndEvent(), observer );
+
+  return stage.ProgressWeight;
+}
+
+inline void
+HessianPipelineReport
+::WriteJSON( std::ostream & os ) const
+{
+  const double pixels = std::max< double >( 1.0, m_NumberOfPixels );
+
+  os << "{\"filter\": \"" << m_FilterName << "\""
+     << ", \"pixels\": " << m_NumberOfPixels
+     << ", \"threads\": " << m_NumberOfThreads
+     << ", \"wall_seconds\": " << m_WallTime
+     << ", \"cpu_seconds\": " << m_CPUTime
+     << ", \"allocated_bytes\": " << this->GetAllocatedBytes()
+     << ", \"stages\": [";
+
+  for ( unsigned int i = 0; i < m_Stages.size(); ++i )
+    {
+    const StageType & stage = m_Stages[i];
+    os << ( i ? ", " : "" )
+       << "{\"name\": \"" << stage.Name << "\""
+       << ", \"wall_seconds\": " << stage.WallTime
+       << ", \"cpu_seconds\": " << stage.CPUTime
+       << ", \"allocated_bytes\": " << stage.AllocatedBytes
+       << ", \"seconds_per_pixel\": " << stage.WallTime / pixels
+       << ", \"bytes_per_pixel\": " << stage.AllocatedBytes / pixels
+       << ", \"threads\": " << stage.NumberOfThreads
+       << ", \"progress_weight\": " << stage.ProgressWeight
+       << ", \"region\": {\"index\": [";
+    for ( unsigned int k = 0; k < stage.RegionIndex.size(); ++k )
+      {
+      os << ( k ? ", " : "" ) << stage.RegionIndex[k];
+      }
+    os << "], \"size\": [";
+    for ( unsigned int k = 0; k < stage.RegionSize.size(); ++k )
+      {
+      os << ( k ? ", " : "" ) << stage.RegionSize[k];
+      }
+    os << "]}}";
+    }
+
+  os << "]}" << std::endl;
+}
+
+inline void
+HessianPipelineReport
+::AppendJSON( const std::string & fileName ) const
+{
+  std::ofstream file( fileName.c_str(), std::ios::app );
+  if ( !file )
+    {
+    itkGenericExceptionMacro("Unable to open " << fileName << " for writing.");
+    }
+  this->WriteJSON( file );
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkHessianPipelineReport_h
@@ -0,0 +1,99 @@
+#ifndef __itkMemoryMappedImportImageContainer_h
+#define __itkMemoryMappedImportImageContainer_h
+
+#include "itkImportImageContainer.h"
+
+#include <map>
+#include <string>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class MemoryMappedImportImageContainer
+ * \brief An image container whose elements are in a memory mapped
+ * scratch file.
+ *
+ * The elements allocated by the container are mapped from a temporary
+ * file created in Directory, which is removed as soon as it is
+ * mapped, so that nothing is left behind when the process ends. The
+ * operating system writes the pages back to the file when memory is
+ * needed, and an image larger than the physical memory may be
+ * processed, at the speed of the disk when it is accessed in the
+ * order of the buffer. The new elements are zero.
+ *
+ * Set it as the pixel container of an image before the image is
+ * allocated:
+ *
+ * \code
+ * image->SetRegions( region );
+ * image->SetPixelContainer( MemoryMappedImportImageContainer< SizeValueType, PixelType >::New() );
+ * image->Allocate();
+ * \endcode
+ *
+ * Memory mapping is only available on POSIX systems, elsewhere the
+ * elements are allocated as by the ImportImageContainer, with a
+ * warning.
+ *
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TElementIdentifier, typename TElement >
+class MemoryMappedImportImageContainer:
+    public ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedImportImageContainer                     Self;
+  typedef ImportImageContainer< TElementIdentifier, TElement > Superclass;
+  typedef SmartPointer< Self >                                 Pointer;
+  typedef SmartPointer< const Self >                           ConstPointer;
+
+  typedef typename Superclass::ElementIdentifier ElementIdentifier;
+  typedef typename Superclass::Element           Element;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set the directory of the scratch files. Default is the TMPDIR
+   * environment variable, or /tmp. */
+  itkSetStringMacro( Directory );
+  itkGetStringMacro( Directory );
+
+protected:
+
+  MemoryMappedImportImageContainer();
+  virtual ~MemoryMappedImportImageContainer();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Map the elements from a new scratch file */
+  virtual TElement * AllocateElements(ElementIdentifier size, bool UseDefaultConstructor = false) const;
+
+  /** Unmap the elements if they are mapped */
+  virtual void DeallocateManagedMemory();
+
+private:
+
+  MemoryMappedImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  /** The number of bytes of each mapping. A new mapping is allocated
+   * before the previous one is released when the container grows. */
+  typedef std::map< TElement *, size_t > MappingsType;
+
+  mutable MappingsType m_Mappings;
+  std::string          m_Directory;
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMemoryMappedImportImageContainer.hxx"
+#endif
+
+#endif // __itkMemoryMappedImportImageContainer_h
@@ -0,0 +1,118 @@
+#ifndef __itkMemoryMappedImportImageContainer_hxx
+#define __itkMemoryMappedImportImageContainer_hxx
+
+#include "itkMemoryMappedImportImageContainer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ITK_DISCRETE_HESSIAN_USE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace Local
+{
+
+template< typename TElementIdentifier, typename TElement >
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::MemoryMappedImportImageContainer()
+{
+  const char *tmp = std::getenv( "TMPDIR" );
+  m_Directory = ( tmp && *tmp ) ? tmp : "/tmp";
+}
+
+template< typename TElementIdentifier, typename TElement >
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::~MemoryMappedImportImageContainer()
+{
+  // the destructor of the superclass would delete the mapped elements
+  this->DeallocateManagedMemory();
+}
+
+template< typename TElementIdentifier, typename TElement >
+TElement *
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::AllocateElements(ElementIdentifier size, bool UseDefaultConstructor) const
+{
+#ifdef ITK_DISCRETE_HESSIAN_USE_MMAP
+  // a new file is zero filled, as are value initialized elements
+  (void) UseDefaultConstructor;
+
+  const size_t bytes = std::max< size_t >( 1, static_cast< size_t >( size ) * sizeof( TElement ) );
+
+  const std::string pattern = m_Directory + "/itkMemoryMappedImportImageContainerXXXXXX";
+  std::vector< char > fileName( pattern.begin(), pattern.end() );
+  fileName.push_back( '\0' );
+
+  const int fd = mkstemp( &fileName[0] );
+  if ( fd < 0 )
+    {
+    itkExceptionMacro("Unable to create a scratch file in " << m_Directory);
+    }
+
+  // the file is removed when it is no longer mapped
+  unlink( &fileName[0] );
+
+  if ( ftruncate( fd, static_cast< off_t >( bytes ) ) != 0 )
+    {
+    close( fd );
+    itkExceptionMacro("Unable to resize a scratch file in " << m_Directory << " to " << bytes << " bytes");
+    }
+
+  void *data = mmap( 0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+
+  if ( data == MAP_FAILED )
+    {
+    itkExceptionMacro("Unable to map " << bytes << " bytes of a scratch file in " << m_Directory);
+    }
+
+  m_Mappings[static_cast< TElement * >( data )] = bytes;
+
+  return static_cast< TElement * >( data );
+#else
+  itkWarningMacro("Memory mapping is not available on this platform, the "
+                  << size << " elements are allocated in memory.");
+  return Superclass::AllocateElements( size, UseDefaultConstructor );
+#endif
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::DeallocateManagedMemory()
+{
+  typename MappingsType::iterator it = m_Mappings.find( this->GetImportPointer() );
+  if ( it != m_Mappings.end() )
+    {
+#ifdef ITK_DISCRETE_HESSIAN_USE_MMAP
+    munmap( it->first, it->second );
+#endif
+    m_Mappings.erase( it );
+
+    // the elements are released, only reset the pointer
+    this->SetContainerManageMemory( false );
+    }
+
+  Superclass::DeallocateManagedMemory();
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "Directory: " << m_Directory << std::endl;
+  os << "Mappings: " << m_Mappings.size() << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkMemoryMappedImportImageContainer_hxx
@@ -0,0 +1,164 @@
+#ifndef __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_h
+#define __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkSymmetricSecondRankTensor.h"
+#include "itkPixelTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class MultiScaleDiscreteHessianRecursiveGaussianImageFilter
+ * \brief Computes the Hessian over a range of scales, reusing the
+ * smoothing of the smaller scales.
+ *
+ * The sigmas are processed in increasing order. The image smoothed
+ * at sigma_{k-1} is smoothed again by the recursive Gaussian with
+ * sqrt(sigma_k^2 - sigma_{k-1}^2), instead of smoothing the input from
+ * scratch at each scale. The Hessian at each scale is then computed
+ * by central differences as in the
+ * DiscreteHessianRecursiveGaussianImageFilter.
+ *
+ * Only one smoothed image and the Hessian of the current scale are
+ * kept in memory. The first output is, for each pixel, the Hessian
+ * at the scale with the largest scale-normalized response, which is
+ * the Frobenius norm of sigma^2 H. The second output holds the sigma
+ * of that scale. The output pixel must be a SymmetricSecondRankTensor.
+ *
+ * Other per-pixel reductions may be implemented with an observer of
+ * the IterationEvent, which is invoked after the Hessian of each
+ * scale is computed, and may use GetCurrentSigma() and
+ * GetCurrentHessian().
+ *
+ * The recursive Gaussian is an approximation, and repeated smoothing
+ * with increments smaller than the pixel spacing accumulates its
+ * error. The sigmas should be spaced accordingly.
+ *
+ * \sa DiscreteHessianRecursiveGaussianImageFilter
+ *
+ * \ingroup GradientFilters
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage,
+          typename TOutputImage = Image< SymmetricSecondRankTensor<
+                                           typename NumericTraits< typename TInputImage::PixelType >::RealType,
+                                           TInputImage::ImageDimension >,
+                                         TInputImage::ImageDimension >,
+          typename TInternalRealType = typename NumericTraits<
+                                         typename PixelTraits< typename TOutputImage::PixelType >::ValueType >::FloatType >
+class ITK_EXPORT MultiScaleDiscreteHessianRecursiveGaussianImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiScaleDiscreteHessianRecursiveGaussianImageFilter Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >        Superclass;
+  typedef SmartPointer< Self >                                   Pointer;
+  typedef SmartPointer< const Self >                             ConstPointer;
+
+  /** Pixel Type of the input image */
+  typedef TInputImage                                   InputImageType;
+  typedef typename TInputImage::PixelType               PixelType;
+  typedef typename NumericTraits< PixelType >::RealType RealType;
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  /** Type of the output Image */
+  typedef TOutputImage                                       OutputImageType;
+  typedef typename          OutputImageType::PixelType       OutputPixelType;
+  typedef typename PixelTraits< OutputPixelType >::ValueType OutputComponentType;
+
+  /** Type of the intermediate smoothed image */
+  typedef TInternalRealType                          InternalRealType;
+  typedef Image< InternalRealType, ImageDimension >  RealImageType;
+
+  /** Type of the image of the selected sigmas */
+  typedef Image< float, ImageDimension > ScalesImageType;
+
+  typedef std::vector< double > SigmaArrayType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(MultiScaleDiscreteHessianRecursiveGaussianImageFilter, ImageToImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set the sigmas of the scales. Sigma is measured in the units of
+   * image spacing. They are sorted in increasing order. */
+  void SetSigmaArray( const SigmaArrayType & sigmas );
+  const SigmaArrayType & GetSigmaArray() const { return m_SigmaArray; }
+
+  /** Define if the output Hessian is multiplied by sigma^2. The
+   * selection of the scale is always scale-normalized. Default is
+   * off, as for the DiscreteHessianRecursiveGaussianImageFilter. */
+  itkSetMacro( NormalizeAcrossScale, bool );
+  itkGetConstMacro( NormalizeAcrossScale, bool );
+  itkBooleanMacro( NormalizeAcrossScale );
+
+  /** Get the image of the sigma selected at each pixel */
+  ScalesImageType * GetScalesOutput();
+
+  /** During an IterationEvent, the sigma of the current scale */
+  itkGetConstMacro( CurrentSigma, double );
+
+  /** During an IterationEvent, the Hessian of the current scale. It is
+   * not normalized across scale. */
+  const OutputImageType * GetCurrentHessian() const { return m_CurrentHessian.GetPointer(); }
+
+  /** This filter needs all of the input, and produces all of the
+   * output. */
+  virtual void GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError );
+  virtual void EnlargeOutputRequestedRegion( DataObject *output );
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( InputHasNumericTraitsCheck,
+                   ( Concept::HasNumericTraits< PixelType > ) );
+  itkConceptMacro( OutputHasPixelTraitsCheck,
+                   ( Concept::HasPixelTraits< OutputPixelType > ) );
+  /** End concept checking */
+#endif
+protected:
+
+  MultiScaleDiscreteHessianRecursiveGaussianImageFilter();
+  virtual ~MultiScaleDiscreteHessianRecursiveGaussianImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  virtual DataObject::Pointer MakeOutput( DataObjectPointerArraySizeType idx );
+
+  /** Generate Data */
+  void GenerateData(void);
+
+private:
+
+  MultiScaleDiscreteHessianRecursiveGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                                        //purposely not implemented
+
+  /** Keep the Hessian of the current scale where its response is
+   * larger than the one of the output */
+  void UpdateMaximumResponse( double sigma, bool firstScale );
+
+  SigmaArrayType m_SigmaArray;
+  bool           m_NormalizeAcrossScale;
+
+  double                             m_CurrentSigma;
+  typename OutputImageType::Pointer  m_CurrentHessian;
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter.hxx"
+#endif
+
+#endif // __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_h
@@ -0,0 +1,289 @@
+#ifndef __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_hxx
+#define __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_hxx
+
+#include "itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkBlockedRecursiveGaussianImageFilter.h"
+#include "itkHessianImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressAccumulator.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::MultiScaleDiscreteHessianRecursiveGaussianImageFilter()
+{
+  m_NormalizeAcrossScale = false;
+  m_SigmaArray.push_back( 1.0 );
+  m_CurrentSigma = 0.0;
+
+  this->ProcessObject::SetNumberOfRequiredOutputs( 2 );
+  this->ProcessObject::SetNthOutput( 1, this->MakeOutput( 1 ) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+DataObject::Pointer
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::MakeOutput( DataObjectPointerArraySizeType idx )
+{
+  if ( idx == 1 )
+    {
+    return static_cast< DataObject * >( ScalesImageType::New().GetPointer() );
+    }
+  return Superclass::MakeOutput( idx );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+typename MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >::ScalesImageType *
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GetScalesOutput()
+{
+  return dynamic_cast< ScalesImageType * >( this->ProcessObject::GetOutput( 1 ) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::SetSigmaArray( const SigmaArrayType & sigmas )
+{
+  SigmaArrayType sortedSigmas( sigmas );
+  std::sort( sortedSigmas.begin(), sortedSigmas.end() );
+
+  if ( sortedSigmas.empty() || sortedSigmas.front() <= 0.0 )
+    {
+    itkExceptionMacro( "At least one sigma is required, and all sigmas must be positive." );
+    }
+
+  if ( sortedSigmas != m_SigmaArray )
+    {
+    m_SigmaArray = sortedSigmas;
+    this->Modified();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError )
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  // This filter needs all of the input
+  typename InputImageType::Pointer image = const_cast< InputImageType * >( this->GetInput() );
+
+  if ( image )
+    {
+    image->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::EnlargeOutputRequestedRegion( DataObject *output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GenerateData(void)
+{
+  itkDebugMacro(<< "MultiScaleDiscreteHessianRecursiveGaussianImageFilter generating data ");
+
+  typename InputImageType::ConstPointer  input = this->GetInput();
+  typename OutputImageType::Pointer      output = this->GetOutput();
+  typename ScalesImageType::Pointer      scales = this->GetScalesOutput();
+
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+  scales->SetBufferedRegion( output->GetRequestedRegion() );
+  scales->Allocate();
+
+  // Create a process accumulator for tracking the progress of this
+  // minipipeline
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+
+  const float filterWeight = 1.0/( m_SigmaArray.size() * ( ImageDimension + 1 ) );
+
+  typedef BlockedRecursiveGaussianImageFilter< InputImageType, RealImageType > FirstGaussianFilterType;
+  typedef BlockedRecursiveGaussianImageFilter< RealImageType, RealImageType >  RealGaussianFilterType;
+  typedef itk::Local::HessianImageFilter< RealImageType, OutputImageType >   HessianImageFilterType;
+
+  // the input smoothed at the previous sigma
+  typename RealImageType::Pointer smoothed;
+  double previousSigma = 0.0;
+
+  for ( unsigned int k = 0; k < m_SigmaArray.size(); ++k )
+    {
+    const double sigma = m_SigmaArray[k];
+
+    // the Gaussian is a semi-group, only smooth by the difference
+    // with the previous scale
+    const double deltaSigma = vcl_sqrt( sigma * sigma - previousSigma * previousSigma );
+
+    if ( deltaSigma > 0.0 )
+      {
+      typename FirstGaussianFilterType::Pointer firstGaussian;
+      std::vector< typename RealGaussianFilterType::Pointer > gaussianFilters;
+
+      RealImageType *current = smoothed.GetPointer();
+
+      if ( k == 0 )
+        {
+        // Convert the input to the real pixel type,
+        // Do not perform operation in-place as not to steal input data
+        firstGaussian = FirstGaussianFilterType::New();
+        firstGaussian->SetOrder( FirstGaussianFilterType::ZeroOrder );
+        firstGaussian->SetNormalizeAcrossScale( false );
+        firstGaussian->SetSigma( deltaSigma );
+        firstGaussian->SetDirection( ImageDimension - 1 );
+        firstGaussian->InPlaceOff();
+        firstGaussian->SetInput( input );
+
+        progress->RegisterInternalFilter( firstGaussian, filterWeight );
+
+        current = firstGaussian->GetOutput();
+        }
+
+      // All remaining passes are inplace on the previously smoothed
+      // image
+      for ( int direction = static_cast< int >( ImageDimension ) - ( ( k == 0 ) ? 2 : 1 ); direction >= 0; --direction )
+        {
+        typename RealGaussianFilterType::Pointer gaussian = RealGaussianFilterType::New();
+        gaussian->SetInput( current );
+        gaussian->SetOrder( RealGaussianFilterType::ZeroOrder );
+        gaussian->SetNormalizeAcrossScale( false );
+        gaussian->SetSigma( deltaSigma );
+        gaussian->SetDirection( direction );
+        gaussian->InPlaceOn();
+
+        progress->RegisterInternalFilter( gaussian, filterWeight );
+
+        gaussianFilters.push_back( gaussian );
+        current = gaussian->GetOutput();
+        }
+
+      gaussianFilters.back()->Update();
+
+      smoothed = gaussianFilters.back()->GetOutput();
+      smoothed->DisconnectPipeline();
+      }
+
+    typename HessianImageFilterType::Pointer hessian = HessianImageFilterType::New();
+    hessian->SetInput( smoothed );
+
+    progress->RegisterInternalFilter( hessian, filterWeight );
+
+    hessian->Update();
+
+    m_CurrentHessian = hessian->GetOutput();
+    m_CurrentHessian->DisconnectPipeline();
+    m_CurrentSigma = sigma;
+
+    this->InvokeEvent( IterationEvent() );
+
+    this->UpdateMaximumResponse( sigma, k == 0 );
+
+    m_CurrentHessian = 0;
+    previousSigma = sigma;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::UpdateMaximumResponse( double sigma, bool firstScale )
+{
+  const double sigma2 = sigma * sigma;
+
+  OutputImageType *output = this->GetOutput();
+  ScalesImageType *scales = this->GetScalesOutput();
+
+  const typename OutputImageType::RegionType region = output->GetRequestedRegion();
+
+  ImageRegionConstIterator< OutputImageType > cit( m_CurrentHessian, region );
+  ImageRegionIterator< OutputImageType >      oit( output, region );
+  ImageRegionIterator< ScalesImageType >      sit( scales, region );
+
+  for ( ; !cit.IsAtEnd(); ++cit, ++oit, ++sit )
+    {
+    const OutputPixelType H = cit.Get();
+
+    bool replace = firstScale;
+
+    if ( !firstScale )
+      {
+      const OutputPixelType best = oit.Get();
+
+      // squared Frobenius norms of the Hessians
+      double response = 0.0;
+      double bestResponse = 0.0;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        for ( unsigned int j = 0; j < ImageDimension; ++j )
+          {
+          response += H(i,j) * H(i,j);
+          bestResponse += best(i,j) * best(i,j);
+          }
+        }
+
+      // scale-normalize the responses, the response of the current
+      // scale by sigma^4. When NormalizeAcrossScale is on, the stored
+      // best Hessian is already multiplied by its sigma^2, so only the
+      // current response gets the sigma^4 factor.
+      const double bestSigma2 = ( m_NormalizeAcrossScale ) ? 1.0 : vnl_math_sqr( sit.Get() );
+      replace = response * sigma2 * sigma2 > bestResponse * bestSigma2 * bestSigma2;
+      }
+
+    if ( replace )
+      {
+      OutputPixelType o = H;
+      if ( m_NormalizeAcrossScale )
+        {
+        for ( unsigned int i = 0; i < OutputPixelType::Length; ++i )
+          {
+          o[i] = H[i] * sigma2;
+          }
+        }
+      oit.Set( o );
+      sit.Set( sigma );
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+MultiScaleDiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "NormalizeAcrossScale: " << m_NormalizeAcrossScale << std::endl;
+  os << "SigmaArray:";
+  for ( unsigned int k = 0; k < m_SigmaArray.size(); ++k )
+    {
+    os << " " << m_SigmaArray[k];
+    }
+  os << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter_hxx
@@ -0,0 +1,76 @@
+#ifndef __itkRecursiveGaussianLineKernel_h
+#define __itkRecursiveGaussianLineKernel_h
+
+#include "itkImage.h"
+#include "itkBlockedRecursiveGaussianImageFilter.h"
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class RecursiveGaussianLineKernel
+ * \brief Exposes the one dimensional recursive Gaussian of the
+ * RecursiveGaussianImageFilter for use on line buffers.
+ *
+ * This class is not intended to be used as a filter. It is used by
+ * the filters in this module which smooth lines in their own
+ * traversal order, and need results identical to the
+ * RecursiveGaussianImageFilter.
+ *
+ * Set the Sigma, Order and NormalizeAcrossScale as with the
+ * RecursiveGaussianImageFilter, then call InitializeCoefficients with
+ * the spacing of the lines before calling FilterLine, or FilterLines
+ * for interleaved lines. They may be called concurrently from
+ * multiple threads.
+ * \sa BlockedRecursiveGaussianImageFilter::FilterLines
+ *
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TRealType = double >
+class RecursiveGaussianLineKernel:
+    public BlockedRecursiveGaussianImageFilter< Image< TRealType, 1 >, Image< TRealType, 1 > >
+{
+public:
+  /** Standard class typedefs. */
+  typedef RecursiveGaussianLineKernel                                                         Self;
+  typedef BlockedRecursiveGaussianImageFilter< Image< TRealType, 1 >, Image< TRealType, 1 > > Superclass;
+  typedef SmartPointer< Self >                                                                Pointer;
+  typedef SmartPointer< const Self >                                                          ConstPointer;
+
+  /** Type used for the line buffers */
+  typedef typename Superclass::RealType RealType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(RecursiveGaussianLineKernel, BlockedRecursiveGaussianImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Compute the filter coefficients for lines with the given spacing. */
+  void InitializeCoefficients( double spacing )
+  {
+    this->SetUp( spacing );
+  }
+
+  /** Filter a line of ln samples from data into outs. The scratch
+   * buffer must also have ln elements, and ln must be at least 4. */
+  void FilterLine( RealType *outs, const RealType *data, RealType *scratch, SizeValueType ln ) const
+  {
+    const_cast< Self * >( this )->FilterDataArray( outs, data, scratch, ln );
+  }
+
+protected:
+  RecursiveGaussianLineKernel() {}
+  virtual ~RecursiveGaussianLineKernel() {}
+
+private:
+  RecursiveGaussianLineKernel(const Self &); //purposely not implemented
+  void operator=(const Self &);              //purposely not implemented
+};
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkRecursiveGaussianLineKernel_h
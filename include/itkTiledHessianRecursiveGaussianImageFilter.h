@@ -0,0 +1,209 @@
+#ifndef __itkTiledHessianRecursiveGaussianImageFilter_h
+#define __itkTiledHessianRecursiveGaussianImageFilter_h
+
+#include "itkFusedHessianRecursiveGaussianImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkMutexLock.h"
+#include "itkConditionVariable.h"
+#include "itkMemoryMappedImportImageContainer.h"
+
+#include <deque>
+#include <vector>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * \class TiledHessianRecursiveGaussianImageFilter
+ * \brief Smooths with a recursive Gaussian along all directions and
+ * computes the Hessian, scheduling the work as dependent tasks on
+ * tiles of the image.
+ *
+ * The composite Hessian filters update one internal filter per
+ * direction, and each waits for all of its threads before the next
+ * one starts. This filter instead runs all of the passes in a single
+ * multi-threaded section, where the threads take ready tasks from a
+ * single FIFO queue shared by all threads, guarded by one mutex and
+ * one condition variable. There is no work-stealing and no per-thread
+ * queue: an idle thread waits on the condition variable until a task
+ * becomes ready. The tasks are:
+ *
+ * - the smoothing along the last direction, on chunks of lines,
+ * - the smoothing along directions ImageDimension-2 to 1 of a slab
+ *   along the last direction, once all of the first tasks are done,
+ * - the smoothing along direction 0 and the central differences of a
+ *   slab, as by the FusedHessianRecursiveGaussianImageFilter, as soon
+ *   as the slab and its two neighbors have been smoothed.
+ *
+ * The smoothing along the last direction needs complete lines, so
+ * every slab task depends on all of the tasks of the first stage:
+ * this is a global barrier, where all threads wait for the last of
+ * them. It is the only one, the Hessian of a slab only waits for its
+ * two neighbors. The progress is the fraction of the completed tasks,
+ * reported by thread 0 out of the lock of the queue.
+ *
+ * When a task throws, or the filter is aborted, no further task is
+ * started, the threads return once their current task is done, and
+ * the first exception, or ProcessAborted, is rethrown by GenerateData.
+ * The output is the same as the
+ * FusedHessianRecursiveGaussianImageFilter applied to the input
+ * smoothed along the other directions.
+ *
+ * The whole input is smoothed into an intermediate image of
+ * TInternalRealType. The smoothing reads and writes bundles of
+ * columns of the rows along direction 0, which are contiguous in the
+ * buffers, rather than single lines across the rows. The lines of a
+ * bundle are filtered together, as by the
+ * BlockedRecursiveGaussianImageFilter, and a bundle holds at most
+ * 256K pixels whatever the size of the image, for lines of up to 32K
+ * pixels.
+ *
+ * When UseMemoryMapping is on, the intermediate image and the outputs
+ * are backed by memory mapped scratch files, so that images larger
+ * than the physical memory may be processed. The rows of a bundle,
+ * and the slices of a Hessian slab, are then read from the files in
+ * order. The input is not mapped, and must still fit in memory.
+ * \sa MemoryMappedImportImageContainer
+ *
+ * \sa DiscreteHessianRecursiveGaussianImageFilter::SetUseTaskScheduler
+ *
+ * \ingroup GradientFilters
+ * \ingroup ITKDiscreteHessian
+ */
+template< typename TInputImage,
+          typename TOutputImage = Image< SymmetricSecondRankTensor<
+                                           typename NumericTraits< typename TInputImage::PixelType >::RealType,
+                                           TInputImage::ImageDimension >,
+                                         TInputImage::ImageDimension >,
+          typename TInternalRealType = double >
+class ITK_EXPORT TiledHessianRecursiveGaussianImageFilter:
+    public FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef TiledHessianRecursiveGaussianImageFilter                             Self;
+  typedef FusedHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                                                 Pointer;
+  typedef SmartPointer< const Self >                                           ConstPointer;
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef typename Superclass::InputImageType         InputImageType;
+  typedef typename Superclass::PixelType              PixelType;
+  typedef typename Superclass::OutputImageType        OutputImageType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+  typedef typename Superclass::LineKernelType         LineKernelType;
+  typedef typename Superclass::RealType               RealType;
+
+  /** Type of the intermediate smoothed image */
+  typedef TInternalRealType                          InternalRealType;
+  typedef Image< InternalRealType, ImageDimension >  RealImageType;
+
+  /** Run-time type information (and related methods).   */
+  itkTypeMacro(TiledHessianRecursiveGaussianImageFilter, FusedHessianRecursiveGaussianImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set the number of tasks of each stage per thread. More tasks
+   * balance the load better, but the slabs are thinner and more
+   * slices are smoothed twice along direction 0. Default is 4. */
+  itkSetClampMacro( TasksPerThread, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( TasksPerThread, unsigned int );
+
+  /** Back the intermediate image and the outputs by memory mapped
+   * scratch files. Default is off. */
+  itkSetMacro( UseMemoryMapping, bool );
+  itkGetConstMacro( UseMemoryMapping, bool );
+  itkBooleanMacro( UseMemoryMapping );
+
+  /** Set the directory of the scratch files. Default is the TMPDIR
+   * environment variable, or /tmp.
+   * \sa MemoryMappedImportImageContainer::SetDirectory */
+  itkSetStringMacro( MemoryMappingDirectory );
+  itkGetStringMacro( MemoryMappingDirectory );
+
+  /** This filter needs all of the input.
+   * \sa ImageToImageFilter::GenerateInputRequestedRegion() */
+  virtual void GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError );
+
+protected:
+
+  TiledHessianRecursiveGaussianImageFilter();
+  virtual ~TiledHessianRecursiveGaussianImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  void GenerateData();
+
+private:
+
+  TiledHessianRecursiveGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                           //purposely not implemented
+
+  /** The kinds of tasks, in the order of their dependencies */
+  enum TaskKind { SmoothLastDirectionTask, SmoothSlabTask, HessianSlabTask };
+
+  struct Task
+  {
+    TaskKind                    m_Kind;
+    OutputImageRegionType       m_Region;
+    unsigned int                m_NumberOfDependencies;
+    std::vector< unsigned int > m_Dependents;
+  };
+
+  /** The threads execute tasks until all are done, or until a task
+   * throws or the filter is aborted */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg );
+
+  void ExecuteTasks( ThreadIdType threadId );
+
+  /** Returns the bytes of the buffers allocated by the task */
+  SizeValueType ExecuteTask( const Task & task );
+
+  /** Smooth the lines along a direction of a region. Returns the bytes
+   * of the bundle buffers. */
+  template< typename TImage >
+  SizeValueType SmoothLines( const TImage *image, const OutputImageRegionType & region, unsigned int direction );
+
+  unsigned int m_TasksPerThread;
+  bool         m_UseMemoryMapping;
+  std::string  m_MemoryMappingDirectory;
+
+  typename RealImageType::Pointer                 m_SmoothedImage;
+  std::vector< typename LineKernelType::Pointer > m_LineKernels;
+
+  std::vector< Task >         m_Tasks;
+  std::deque< unsigned int >  m_ReadyTasks;
+  unsigned int                m_NumberOfCompletedTasks;
+  unsigned int                m_NumberOfReportedTasks;
+  bool                        m_TasksStopped;
+  bool                        m_TasksFailed;
+  bool                        m_TasksAborted;
+  ExceptionObject             m_TaskException;
+
+  SimpleMutexLock             m_TasksLock;
+  ConditionVariable::Pointer  m_TasksCondition;
+};
+
+/** The tiled filter allocates the intermediate smoothed image, and
+ * the buffers of its threads
+ * \sa HessianPipelineReport */
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+SizeValueType ComputeHessianStageInternalBytes( const TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType > *filter )
+{
+  return filter->GetInput()->GetBufferedRegion().GetNumberOfPixels() * sizeof( TInternalRealType )
+         + filter->GetThreadBufferBytes();
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTiledHessianRecursiveGaussianImageFilter.hxx"
+#endif
+
+#endif // __itkTiledHessianRecursiveGaussianImageFilter_h
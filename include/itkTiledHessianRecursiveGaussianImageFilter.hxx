@@ -0,0 +1,479 @@
+#ifndef __itkTiledHessianRecursiveGaussianImageFilter_hxx
+#define __itkTiledHessianRecursiveGaussianImageFilter_hxx
+
+#include "itkTiledHessianRecursiveGaussianImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace itk
+{
+namespace Local
+{
+
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::TiledHessianRecursiveGaussianImageFilter()
+{
+  m_TasksPerThread = 4;
+  m_UseMemoryMapping = false;
+  m_NumberOfCompletedTasks = 0;
+  m_NumberOfReportedTasks = 0;
+  m_TasksStopped = false;
+  m_TasksFailed = false;
+  m_TasksAborted = false;
+  m_TasksCondition = ConditionVariable::New();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GenerateInputRequestedRegion()
+  throw( InvalidRequestedRegionError )
+{
+  // call the superclass' implementation of this method, then enlarge
+  // the padded region to all of the input, which this filter needs
+  Superclass::GenerateInputRequestedRegion();
+
+  typename InputImageType::Pointer image = const_cast< InputImageType * >( this->GetInput() );
+
+  if ( image )
+    {
+    image->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::GenerateData()
+{
+  // the direction of the slabs, and the direction along which the
+  // smoothing along the slabs is split
+  const unsigned int R = ImageDimension - 1;
+  const unsigned int P = ImageDimension - 2;
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType      *output = this->GetOutput();
+
+  const typename InputImageType::RegionType bufferedRegion = input->GetBufferedRegion();
+
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( bufferedRegion.GetSize( d ) < 4 )
+      {
+      itkExceptionMacro("The number of pixels along direction " << d << " is less than 4. This filter requires a minimum of four pixels along the dimension to be processed.");
+      }
+    }
+
+  if ( m_UseMemoryMapping )
+    {
+    // the outputs were initialized by the pipeline, replace their
+    // containers before they are allocated
+    typedef MemoryMappedImportImageContainer< SizeValueType, typename OutputImageType::PixelType > OutputContainerType;
+    for ( unsigned int k = 0; k < this->GetNumberOfOutputs(); ++k )
+      {
+      typename OutputContainerType::Pointer container = OutputContainerType::New();
+      if ( !m_MemoryMappingDirectory.empty() )
+        {
+        container->SetDirectory( m_MemoryMappingDirectory );
+        }
+      this->GetOutput( k )->SetPixelContainer( container );
+      }
+    }
+
+  this->AllocateOutputs();
+
+  // the kernel along direction 0
+  this->BeforeThreadedGenerateData();
+
+  m_LineKernels.resize( ImageDimension );
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    m_LineKernels[d] = LineKernelType::New();
+    m_LineKernels[d]->SetSigma( this->GetSigma() );
+    m_LineKernels[d]->InitializeCoefficients( input->GetSpacing()[d] );
+    }
+
+  m_SmoothedImage = RealImageType::New();
+  m_SmoothedImage->CopyInformation( input );
+  m_SmoothedImage->SetRegions( bufferedRegion );
+  if ( m_UseMemoryMapping )
+    {
+    typedef MemoryMappedImportImageContainer< SizeValueType, InternalRealType > SmoothedContainerType;
+    typename SmoothedContainerType::Pointer container = SmoothedContainerType::New();
+    if ( !m_MemoryMappingDirectory.empty() )
+      {
+      container->SetDirectory( m_MemoryMappingDirectory );
+      }
+    m_SmoothedImage->SetPixelContainer( container );
+    }
+  m_SmoothedImage->Allocate();
+
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  const SizeValueType maximumNumberOfTasks = numberOfThreads * m_TasksPerThread;
+
+  // Build the task graph
+  m_Tasks.clear();
+  m_ReadyTasks.clear();
+  m_NumberOfCompletedTasks = 0;
+  m_NumberOfReportedTasks = 0;
+  m_TasksStopped = false;
+  m_TasksFailed = false;
+  m_TasksAborted = false;
+
+  // the smoothing along the last direction, split along direction P
+  const SizeValueType numberOfChunks = std::min( bufferedRegion.GetSize( P ), maximumNumberOfTasks );
+  for ( SizeValueType k = 0; k < numberOfChunks; ++k )
+    {
+    const IndexValueType begin = k * bufferedRegion.GetSize( P ) / numberOfChunks;
+    const IndexValueType end = ( k + 1 ) * bufferedRegion.GetSize( P ) / numberOfChunks;
+
+    Task task;
+    task.m_Kind = SmoothLastDirectionTask;
+    task.m_Region = bufferedRegion;
+    task.m_Region.SetIndex( P, bufferedRegion.GetIndex( P ) + begin );
+    task.m_Region.SetSize( P, end - begin );
+    task.m_NumberOfDependencies = 0;
+    m_Tasks.push_back( task );
+    m_ReadyTasks.push_back( k );
+    }
+
+  // the slabs along the last direction are at least 4 slices thick,
+  // so that few slices are smoothed twice by the Hessian tasks
+  const SizeValueType numberOfSlabs = std::max< SizeValueType >( 1, std::min( bufferedRegion.GetSize( R ) / 4, maximumNumberOfTasks ) );
+  const unsigned int  firstSlabTask = m_Tasks.size();
+  const unsigned int  firstHessianTask = firstSlabTask + numberOfSlabs;
+
+  for ( SizeValueType s = 0; s < numberOfSlabs; ++s )
+    {
+    const IndexValueType begin = s * bufferedRegion.GetSize( R ) / numberOfSlabs;
+    const IndexValueType end = ( s + 1 ) * bufferedRegion.GetSize( R ) / numberOfSlabs;
+
+    Task task;
+    task.m_Kind = SmoothSlabTask;
+    task.m_Region = bufferedRegion;
+    task.m_Region.SetIndex( R, bufferedRegion.GetIndex( R ) + begin );
+    task.m_Region.SetSize( R, end - begin );
+    task.m_NumberOfDependencies = numberOfChunks;
+    task.m_Dependents.push_back( firstHessianTask + s );
+    if ( s > 0 )
+      {
+      task.m_Dependents.push_back( firstHessianTask + s - 1 );
+      }
+    if ( s + 1 < numberOfSlabs )
+      {
+      task.m_Dependents.push_back( firstHessianTask + s + 1 );
+      }
+    m_Tasks.push_back( task );
+
+    for ( SizeValueType k = 0; k < numberOfChunks; ++k )
+      {
+      m_Tasks[k].m_Dependents.push_back( firstSlabTask + s );
+      }
+    }
+
+  for ( SizeValueType s = 0; s < numberOfSlabs; ++s )
+    {
+    const Task &slabTask = m_Tasks[firstSlabTask + s];
+
+    Task task;
+    task.m_Kind = HessianSlabTask;
+    task.m_Region = output->GetRequestedRegion();
+    if ( !task.m_Region.Crop( slabTask.m_Region ) )
+      {
+      task.m_Region.SetSize( R, 0 );
+      }
+    // the neighbor slabs are the same for the slab and its Hessian
+    task.m_NumberOfDependencies = slabTask.m_Dependents.size();
+    m_Tasks.push_back( task );
+    }
+
+  // Execute the tasks
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_Tasks.clear();
+  m_ReadyTasks.clear();
+  m_LineKernels.clear();
+  m_SmoothedImage = 0;
+
+  // rethrow the first exception of the tasks in the calling thread
+  if ( m_TasksFailed )
+    {
+    ExceptionObject e = m_TaskException;
+    m_TaskException = ExceptionObject();
+    throw e;
+    }
+
+  if ( m_TasksAborted )
+    {
+    ProcessAborted e(__FILE__, __LINE__);
+    e.SetDescription("Process aborted.");
+    e.SetLocation(ITK_LOCATION);
+    throw e;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+ITK_THREAD_RETURN_TYPE
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::ThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *self = static_cast< Self * >( info->UserData );
+
+  self->ExecuteTasks( info->ThreadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::ExecuteTasks( ThreadIdType threadId )
+{
+  // the buffers of the tasks are freed when they complete, so a
+  // thread holds at most those of its largest task
+  SizeValueType bufferBytes = 0;
+
+  m_TasksLock.Lock();
+  while ( !m_TasksStopped && m_NumberOfCompletedTasks < m_Tasks.size() )
+    {
+    // The progress is reported by thread 0 only, when it finds that
+    // tasks were completed since its last report. It is reported out
+    // of the lock, so that the observers may call back into the filter.
+    const bool reportProgress = ( threadId == 0 && m_NumberOfReportedTasks < m_NumberOfCompletedTasks );
+    unsigned int t = 0;
+    if ( reportProgress )
+      {
+      m_NumberOfReportedTasks = m_NumberOfCompletedTasks;
+      }
+    else if ( this->GetAbortGenerateData() )
+      {
+      m_TasksAborted = true;
+      m_TasksStopped = true;
+      m_TasksCondition->Broadcast();
+      break;
+      }
+    else if ( m_ReadyTasks.empty() )
+      {
+      m_TasksCondition->Wait( &m_TasksLock );
+      continue;
+      }
+    else
+      {
+      t = m_ReadyTasks.front();
+      m_ReadyTasks.pop_front();
+      }
+    const float progress = static_cast< float >( m_NumberOfReportedTasks ) / m_Tasks.size();
+    m_TasksLock.Unlock();
+
+    // an exception must not escape the thread, it is kept and rethrown
+    // by GenerateData
+    bool            succeeded = false;
+    ExceptionObject exception;
+    try
+      {
+      if ( reportProgress )
+        {
+        this->UpdateProgress( progress );
+        }
+      else
+        {
+        bufferBytes = std::max( bufferBytes, this->ExecuteTask( m_Tasks[t] ) );
+        }
+      succeeded = true;
+      }
+    catch ( ExceptionObject & e )
+      {
+      exception = e;
+      }
+    catch ( std::exception & e )
+      {
+      exception = ExceptionObject( __FILE__, __LINE__, e.what(), ITK_LOCATION );
+      }
+    catch ( ... )
+      {
+      exception = ExceptionObject( __FILE__, __LINE__, "Unknown exception in a task.", ITK_LOCATION );
+      }
+
+    m_TasksLock.Lock();
+    if ( !succeeded )
+      {
+      // the other threads finish their current task and return
+      if ( !m_TasksFailed )
+        {
+        m_TaskException = exception;
+        m_TasksFailed = true;
+        }
+      m_TasksStopped = true;
+      m_TasksCondition->Broadcast();
+      break;
+      }
+
+    if ( reportProgress )
+      {
+      continue;
+      }
+
+    ++m_NumberOfCompletedTasks;
+
+    const std::vector< unsigned int > &dependents = m_Tasks[t].m_Dependents;
+    for ( unsigned int k = 0; k < dependents.size(); ++k )
+      {
+      if ( --m_Tasks[dependents[k]].m_NumberOfDependencies == 0 )
+        {
+        m_ReadyTasks.push_back( dependents[k] );
+        }
+      }
+
+    m_TasksCondition->Broadcast();
+    }
+  m_TasksLock.Unlock();
+
+  this->AddThreadBufferBytes( bufferBytes );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+SizeValueType
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::ExecuteTask( const Task & task )
+{
+  SizeValueType bufferBytes = 0;
+  switch ( task.m_Kind )
+    {
+    case SmoothLastDirectionTask:
+      bufferBytes = this->SmoothLines( this->GetInput(), task.m_Region, ImageDimension - 1 );
+      break;
+    case SmoothSlabTask:
+      for ( int d = ImageDimension - 2; d > 0; --d )
+        {
+        bufferBytes = std::max( bufferBytes, this->SmoothLines( m_SmoothedImage.GetPointer(), task.m_Region, d ) );
+        }
+      break;
+    case HessianSlabTask:
+      if ( task.m_Region.GetNumberOfPixels() > 0 )
+        {
+        // the progress is reported per task by ExecuteTasks
+        bufferBytes = this->GenerateRegion( m_SmoothedImage.GetPointer(), task.m_Region, 0 );
+        }
+      break;
+    }
+  return bufferBytes;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+template< typename TImage >
+SizeValueType
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::SmoothLines( const TImage *image, const OutputImageRegionType & region, unsigned int direction )
+{
+  // the image and the smoothed image have the same buffered region
+  const typename TImage::PixelType *in = image->GetBufferPointer();
+  InternalRealType                 *out = m_SmoothedImage->GetBufferPointer();
+
+  const SizeValueType   ln = region.GetSize( direction );
+  const SizeValueType   rowLength = region.GetSize( 0 );
+  const OffsetValueType stride = image->GetOffsetTable()[direction];
+
+  // The lines are filtered in bundles of consecutive columns of a row
+  // along direction 0, or of several whole rows when the rows are
+  // short. At each position along the direction, the columns of a
+  // bundle are copied to and from the bundle buffer, so the image is
+  // accessed by contiguous runs instead of by single pixels. The
+  // width of a bundle is a multiple of the vector width, such that
+  // the bundle holds at most maximumBundleSize pixels.
+  OutputImageRegionType rowRegion = region;
+  rowRegion.SetSize( 0, 1 );
+  rowRegion.SetSize( direction, 1 );
+
+  const SizeValueType maximumBundleSize = 1 << 18;
+  const SizeValueType vectorWidth = LineKernelType::VectorWidth;
+  SizeValueType       columnsPerBundle =
+    std::max< SizeValueType >( vectorWidth, ( maximumBundleSize / ln ) / vectorWidth * vectorWidth );
+  SizeValueType rowsPerBundle = 1;
+  if ( columnsPerBundle >= rowLength )
+    {
+    columnsPerBundle = rowLength;
+    rowsPerBundle = std::max< SizeValueType >( 1, maximumBundleSize / ( rowLength * ln ) );
+    }
+
+  std::vector< OffsetValueType > rowOffsets;
+  std::vector< RealType >        bundle;
+  std::vector< RealType >        filtered;
+  std::vector< RealType >        scratch;
+
+  ImageRegionConstIteratorWithIndex< TImage > rit( image, rowRegion );
+  rit.GoToBegin();
+  while ( !rit.IsAtEnd() )
+    {
+    rowOffsets.clear();
+    for ( ; !rit.IsAtEnd() && rowOffsets.size() < rowsPerBundle; ++rit )
+      {
+      rowOffsets.push_back( image->ComputeOffset( rit.GetIndex() ) );
+      }
+
+    for ( SizeValueType first = 0; first < rowLength; first += columnsPerBundle )
+      {
+      const SizeValueType columns = std::min( columnsPerBundle, rowLength - first );
+      const SizeValueType width = rowOffsets.size() * columns;
+      bundle.resize( ln * width );
+      filtered.resize( ln * width );
+      scratch.resize( ln * width );
+
+      for ( SizeValueType i = 0; i < ln; ++i )
+        {
+        RealType *b = &bundle[i * width];
+        for ( SizeValueType r = 0; r < rowOffsets.size(); ++r )
+          {
+          const typename TImage::PixelType *row = in + rowOffsets[r] + i * stride + first;
+          for ( SizeValueType x = 0; x < columns; ++x )
+            {
+            *b++ = static_cast< RealType >( row[x] );
+            }
+          }
+        }
+
+      // the lines of the bundle are interleaved, and filtered together
+      m_LineKernels[direction]->FilterLines( &filtered[0], &bundle[0], &scratch[0], ln, width );
+
+      for ( SizeValueType i = 0; i < ln; ++i )
+        {
+        const RealType *b = &filtered[i * width];
+        for ( SizeValueType r = 0; r < rowOffsets.size(); ++r )
+          {
+          InternalRealType *row = out + rowOffsets[r] + i * stride + first;
+          for ( SizeValueType x = 0; x < columns; ++x )
+            {
+            row[x] = static_cast< InternalRealType >( *b++ );
+            }
+          }
+        }
+      }
+    }
+
+  return rowOffsets.capacity() * sizeof( OffsetValueType )
+         + ( bundle.capacity() + filtered.capacity() + scratch.capacity() ) * sizeof( RealType );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void
+TiledHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "TasksPerThread: " << m_TasksPerThread << std::endl;
+  os << "UseMemoryMapping: " << m_UseMemoryMapping << std::endl;
+  os << "MemoryMappingDirectory: " << m_MemoryMappingDirectory << std::endl;
+}
+
+} // end namespace Local
+} // end namespace itk
+
+#endif // __itkTiledHessianRecursiveGaussianImageFilter_hxx
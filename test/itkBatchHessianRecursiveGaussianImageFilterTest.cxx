@@ -0,0 +1,132 @@
+#include "itkBatchHessianRecursiveGaussianImageFilter.h"
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+namespace
+{
+
+// compare the batch Hessian of stacked images with the composite
+// filter on each image
+template< unsigned int VDimension >
+int BatchHessianTest( unsigned int imageSize, unsigned int numberOfImages )
+{
+  typedef itk::Image< float, VDimension >     ImageType;
+  typedef itk::Image< float, VDimension + 1 > StackedImageType;
+
+  typename ImageType::SizeType size;
+  size.Fill( imageSize );
+  size[0] += 3;
+
+  typename ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[0] = 0.7;
+
+  // images with Gaussian blobs at different positions
+  std::vector< typename ImageType::Pointer > images;
+  std::vector< const ImageType * >           imagePointers;
+  for ( unsigned int k = 0; k < numberOfImages; ++k )
+    {
+    typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+    typename GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+    gaussianSource->SetSize( size );
+    gaussianSource->SetSpacing( spacing );
+    gaussianSource->SetMean( itk::FixedArray< double, VDimension >( 2.0 + k ) );
+    gaussianSource->SetSigma( itk::FixedArray< double, VDimension >( 3.0 ) );
+    gaussianSource->SetNormalized( false );
+    gaussianSource->SetScale( 1.0 );
+    gaussianSource->Update();
+
+    typename ImageType::Pointer image = gaussianSource->GetOutput();
+    image->DisconnectPipeline();
+
+    images.push_back( image );
+    imagePointers.push_back( images.back().GetPointer() );
+    }
+
+  typedef itk::Local::BatchHessianRecursiveGaussianImageFilter< StackedImageType > BatchFilterType;
+  typedef typename BatchFilterType::OutputImageType                               BatchImageType;
+
+  typename BatchFilterType::Pointer batchHessian = BatchFilterType::New();
+  batchHessian->SetInput( BatchFilterType::StackImages( imagePointers ) );
+  batchHessian->SetSigma( 1.5 );
+  batchHessian->NormalizeAcrossScaleOn();
+  batchHessian->SetOutputScale( 2.5 );
+  batchHessian->Update();
+
+  const BatchImageType *batchOutput = batchHessian->GetOutput();
+  if ( batchOutput->GetLargestPossibleRegion().GetSize( VDimension ) != numberOfImages )
+    {
+    std::cerr << "The output does not have one slice per image!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double outputScale = 0.0;
+  if ( !itk::ExposeMetaData< double >( batchOutput->GetMetaDataDictionary(),
+                                       itk::Local::HessianOutputScaleKey(), outputScale )
+       || outputScale != 2.5 )
+    {
+    std::cerr << "The output scale is not recorded in the output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef typename HessianFilterType::OutputImageType                         HessianImageType;
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  for ( unsigned int k = 0; k < numberOfImages; ++k )
+    {
+    typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+    hessian->SetInput( images[k] );
+    hessian->SetSigma( 1.5 );
+    hessian->NormalizeAcrossScaleOn();
+    hessian->SetOutputScale( 2.5 );
+    hessian->Update();
+
+    // the slice of the image in the batch output
+    typename BatchImageType::RegionType slice = batchOutput->GetLargestPossibleRegion();
+    slice.SetIndex( VDimension, k );
+    slice.SetSize( VDimension, 1 );
+
+    itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                           hessian->GetOutput()->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< BatchImageType >   bit( batchOutput, slice );
+    for ( ; !it.IsAtEnd(); ++it, ++bit )
+      {
+      for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+        {
+        maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+        maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - bit.Get()[i] ) ) );
+        }
+      }
+    }
+
+  std::cout << VDimension << "D maximum value: " << maxValue << std::endl;
+  std::cout << VDimension << "D maximum difference of batch output: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-10 * maxValue )
+    {
+    std::cerr << "Batch output differs from the output of each image!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkBatchHessianRecursiveGaussianImageFilterTest( int, char *[] )
+{
+  if ( BatchHessianTest<2>( 20, 7 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( BatchHessianTest<3>( 12, 5 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include "itkBlockedRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace
+{
+
+template< typename TImage >
+double MaximumDifference( const TImage *image, const TImage *reference, double & maxValue )
+{
+  itk::ImageRegionConstIterator< TImage > it( image, image->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TImage > rit( reference, reference->GetBufferedRegion() );
+
+  double maxDifference = 0.0;
+  maxValue = 0.0;
+  for ( ; !it.IsAtEnd(); ++it, ++rit )
+    {
+    maxValue = std::max( maxValue, std::abs( double( rit.Get() ) ) );
+    maxDifference = std::max( maxDifference, std::abs( double( it.Get() ) - double( rit.Get() ) ) );
+    }
+  return maxDifference;
+}
+
+}
+
+int itkBlockedRecursiveGaussianImageFilterTest( int, char *[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension >  ImageType;
+  typedef itk::Image< double, Dimension > RealImageType;
+
+  ImageType::SizeType size;
+  size[0] = 23;
+  size[1] = 19;
+  size[2] = 17;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.8;
+  spacing[1] = 1.0;
+  spacing[2] = 1.3;
+
+  typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 7.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension >( 3.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  typedef itk::RecursiveGaussianImageFilter< ImageType, RealImageType >            GaussianFilterType;
+  typedef itk::Local::BlockedRecursiveGaussianImageFilter< ImageType, RealImageType > BlockedGaussianFilterType;
+  typedef itk::Local::BlockedRecursiveGaussianImageFilter< RealImageType >            InPlaceGaussianFilterType;
+
+  // the blocked filter gives the output of the recursive Gaussian,
+  // along all directions, for all orders, with rows split into chunks
+  // of VectorWidth columns, chunks of two vectors for the lines of 19
+  // pixels along direction 1, and with the default blocks of several
+  // rows
+  const GaussianFilterType::OrderEnumType orders[] = { GaussianFilterType::ZeroOrder,
+                                                       GaussianFilterType::FirstOrder,
+                                                       GaussianFilterType::SecondOrder };
+  const itk::SizeValueType blockSizes[] = { 1, 100, 2 * BlockedGaussianFilterType::VectorWidth * 19,
+                                            BlockedGaussianFilterType::New()->GetBlockSize() };
+
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    for ( unsigned int o = 0; o < 3; ++o )
+      {
+      GaussianFilterType::Pointer gaussian = GaussianFilterType::New();
+      gaussian->SetInput( gaussianSource->GetOutput() );
+      gaussian->SetSigma( 1.7 );
+      gaussian->SetDirection( d );
+      gaussian->SetOrder( orders[o] );
+      gaussian->Update();
+
+      for ( unsigned int b = 0; b < 4; ++b )
+        {
+        BlockedGaussianFilterType::Pointer blockedGaussian = BlockedGaussianFilterType::New();
+        blockedGaussian->SetInput( gaussianSource->GetOutput() );
+        blockedGaussian->SetSigma( 1.7 );
+        blockedGaussian->SetDirection( d );
+        blockedGaussian->SetOrder( orders[o] );
+        blockedGaussian->SetBlockSize( blockSizes[b] );
+        blockedGaussian->Update();
+
+        double maxValue = 0.0;
+        const double maxDifference = MaximumDifference( blockedGaussian->GetOutput(), gaussian->GetOutput(), maxValue );
+
+        std::cout << "Direction " << d << ", order " << o << ", block size " << blockSizes[b]
+                  << ": maximum difference " << maxDifference << " of " << maxValue << std::endl;
+
+        if ( maxDifference > 1e-10 * maxValue )
+          {
+          std::cerr << "Blocked output differs from the recursive Gaussian output!" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // in place along direction 1, on the output of the recursive
+  // Gaussian along direction 2
+  GaussianFilterType::Pointer gaussian = GaussianFilterType::New();
+  gaussian->SetInput( gaussianSource->GetOutput() );
+  gaussian->SetSigma( 1.7 );
+  gaussian->SetDirection( 2 );
+  gaussian->Update();
+
+  GaussianFilterType::Pointer referenceGaussian = GaussianFilterType::New();
+  referenceGaussian->SetInput( gaussianSource->GetOutput() );
+  referenceGaussian->SetSigma( 1.7 );
+  referenceGaussian->SetDirection( 2 );
+
+  itk::RecursiveGaussianImageFilter< RealImageType >::Pointer referenceInPlace =
+    itk::RecursiveGaussianImageFilter< RealImageType >::New();
+  referenceInPlace->SetInput( referenceGaussian->GetOutput() );
+  referenceInPlace->SetSigma( 1.7 );
+  referenceInPlace->SetDirection( 1 );
+  referenceInPlace->Update();
+
+  InPlaceGaussianFilterType::Pointer inPlaceGaussian = InPlaceGaussianFilterType::New();
+  inPlaceGaussian->SetInput( gaussian->GetOutput() );
+  inPlaceGaussian->SetSigma( 1.7 );
+  inPlaceGaussian->SetDirection( 1 );
+  inPlaceGaussian->InPlaceOn();
+  inPlaceGaussian->Update();
+
+  double maxValue = 0.0;
+  const double maxDifference = MaximumDifference( inPlaceGaussian->GetOutput(), referenceInPlace->GetOutput(), maxValue );
+
+  std::cout << "In place: maximum difference " << maxDifference << " of " << maxValue << std::endl;
+
+  if ( maxDifference > 1e-10 * maxValue )
+    {
+    std::cerr << "In place blocked output differs from the recursive Gaussian output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
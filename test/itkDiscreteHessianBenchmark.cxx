@@ -0,0 +1,504 @@
+/**
+ * Performance benchmark of the Hessian filters.
+ *
+ * Usage: itkDiscreteHessianBenchmark [outputFile|-] [maxThreads] [quick]
+ *
+ * Times the HessianImageFilter and the composite Hessian filters, in
+ * 2D and 3D, for float and double input images, over several image
+ * sizes, sigmas and numbers of threads. Each measurement is written
+ * as a JSON object on its own line, with the fields:
+ *
+ *   filter, dimension, pixel, size, sigma, threads, seconds,
+ *   voxels_per_second, parallel_efficiency, allocated_bytes,
+ *   bytes_per_voxel
+ *
+ * seconds is the best of several updates of the filter.
+ * parallel_efficiency is the time with one thread divided by the time
+ * with n threads times n. allocated_bytes is measured for each
+ * configuration: for the composite filters it is the sum of the bytes
+ * allocated by their internal filters in the last update, from their
+ * HessianPipelineReport, for the other filters the bytes of their
+ * output buffers. bytes_per_voxel is allocated_bytes divided by the
+ * number of voxels.
+ *
+ * The DiscreteHessianRecursiveGaussianImageFilter is timed with its
+ * default UseFusedKernel on, with UseFusedKernel off, its filter name
+ * is then suffixed with "+MiniPipeline", and with UseTaskScheduler on,
+ * suffixed with "+TaskScheduler". The bytes_per_voxel of the first two
+ * compare the memory traffic of the fused kernel and of the
+ * mini-pipeline, each allocated byte is written once by a stage and
+ * read once by the next.
+ *
+ * The smoothing along each direction is also timed alone, with the
+ * RecursiveGaussianImageFilter and the BlockedRecursiveGaussianImageFilter
+ * used by the composite filters. These measurements have an additional
+ * direction field, and the blocked filter a speedup field, the time of
+ * the RecursiveGaussianImageFilter divided by its time.
+ *
+ * Batches of small images are timed with the
+ * BatchHessianRecursiveGaussianImageFilter on the stacked images, and
+ * with a DiscreteHessianRecursiveGaussianImageFilter updated for each
+ * image, whose filter name is then suffixed with "+PerImage". These
+ * measurements have an additional images field, the size is that of
+ * each image, and the voxels are those of all of the images, except
+ * for the bytes_per_voxel of the "+PerImage" filter, which allocates
+ * its buffers for one image at a time.
+ *
+ * The "quick" argument runs small images with a single repetition, to
+ * check that the benchmark runs.
+ */
+
+#include "itkHessianImageFilter.h"
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkHessianDiscreteGaussianImageFilter.h"
+#include "itkBlockedRecursiveGaussianImageFilter.h"
+#include "itkBatchHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct BenchmarkOptions
+{
+  std::vector< unsigned int > sizes2D;
+  std::vector< unsigned int > sizes3D;
+  std::vector< double >       sigmas;
+  unsigned int                batchSize2D;
+  unsigned int                batchSize3D;
+  unsigned int                numberOfBatchImages;
+  unsigned int                maxThreads;
+  unsigned int                repetitions;
+};
+
+// the bytes allocated by the last update of a filter, its outputs
+template< typename TFilter >
+itk::SizeValueType AllocatedBytes( const TFilter *filter )
+{
+  return itk::Local::ComputeHessianStageOutputBytes( filter );
+}
+
+// the composite filters report the buffers of their internal filters
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+itk::SizeValueType AllocatedBytes( const itk::Local::DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType > *filter )
+{
+  return filter->GetReport().GetAllocatedBytes();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+itk::SizeValueType AllocatedBytes( const itk::Local::HessianDiscreteGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType > *filter )
+{
+  return filter->GetReport().GetAllocatedBytes();
+}
+
+void WriteAllocatedBytes( std::ostream &os, itk::SizeValueType bytes, double numberOfVoxels )
+{
+  os << ", \"allocated_bytes\": " << bytes
+     << ", \"bytes_per_voxel\": " << bytes / numberOfVoxels;
+}
+
+const char *PixelTypeName( float ) { return "float"; }
+const char *PixelTypeName( double ) { return "double"; }
+
+// the execution modes of the DiscreteHessianRecursiveGaussianImageFilter
+enum Mode { FusedKernel, MiniPipeline, TaskScheduler };
+
+const char *ModeSuffix( Mode mode )
+{
+  switch ( mode )
+    {
+    case MiniPipeline:
+      return "+MiniPipeline";
+    case TaskScheduler:
+      return "+TaskScheduler";
+    default:
+      return "";
+    }
+}
+
+template< typename TFilter >
+void ConfigureFilter( TFilter *filter, double sigma, Mode )
+{
+  filter->SetSigma( sigma );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void ConfigureFilter( itk::Local::HessianImageFilter< TInputImage, TOutputImage > *, double, Mode )
+{
+}
+
+template< typename TInputImage, typename TOutputImage, typename TInternalRealType >
+void ConfigureFilter( itk::Local::DiscreteHessianRecursiveGaussianImageFilter< TInputImage, TOutputImage, TInternalRealType > *filter,
+                      double sigma,
+                      Mode mode )
+{
+  filter->SetSigma( sigma );
+  filter->SetUseFusedKernel( mode != MiniPipeline );
+  filter->SetUseTaskScheduler( mode == TaskScheduler );
+}
+
+// the best time of several updates of a filter
+template< typename TFilter >
+double TimeFilter( TFilter *filter, unsigned int repetitions )
+{
+  double seconds = std::numeric_limits< double >::max();
+  for ( unsigned int r = 0; r < repetitions; ++r )
+    {
+    filter->Modified();
+
+    itk::TimeProbe probe;
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+
+    seconds = std::min< double >( seconds, probe.GetTotal() );
+    }
+  return seconds;
+}
+
+template< typename TFilter >
+void RunBenchmark( const char *name,
+                   typename TFilter::InputImageType *input,
+                   double sigma,
+                   const BenchmarkOptions &options,
+                   std::ostream &os,
+                   Mode mode = FusedKernel )
+{
+  typedef typename TFilter::InputImageType ImageType;
+
+  const double numberOfVoxels = input->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  double serialSeconds = 0.0;
+
+  unsigned int threads = 1;
+  while ( true )
+    {
+    // the filters of the mini-pipelines use the default number of
+    // threads
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads( threads );
+
+    typename TFilter::Pointer filter = TFilter::New();
+    filter->SetInput( input );
+    filter->SetNumberOfThreads( threads );
+    ConfigureFilter( filter.GetPointer(), sigma, mode );
+
+    const double seconds = TimeFilter( filter.GetPointer(), options.repetitions );
+
+    if ( threads == 1 )
+      {
+      serialSeconds = seconds;
+      }
+
+    os << "{\"filter\": \"" << name << ModeSuffix( mode ) << "\""
+       << ", \"dimension\": " << ImageType::ImageDimension
+       << ", \"pixel\": \"" << PixelTypeName( typename ImageType::PixelType() ) << "\""
+       << ", \"size\": " << input->GetLargestPossibleRegion().GetSize( 0 )
+       << ", \"sigma\": " << sigma
+       << ", \"threads\": " << threads
+       << ", \"seconds\": " << seconds
+       << ", \"voxels_per_second\": " << numberOfVoxels / seconds
+       << ", \"parallel_efficiency\": " << serialSeconds / ( seconds * threads );
+    WriteAllocatedBytes( os, AllocatedBytes( filter.GetPointer() ), numberOfVoxels );
+    os << "}" << std::endl;
+
+    if ( threads >= options.maxThreads )
+      {
+      break;
+      }
+    threads = std::min( 2 * threads, options.maxThreads );
+    }
+}
+
+// the recursive Gaussian along each direction, with the blocked and
+// the generic filter
+template< typename TImage >
+void RunAxisBenchmark( TImage *input,
+                       double sigma,
+                       const BenchmarkOptions &options,
+                       std::ostream &os )
+{
+  typedef itk::Image< double, TImage::ImageDimension >                             RealImageType;
+  typedef itk::RecursiveGaussianImageFilter< TImage, RealImageType >               GaussianFilterType;
+  typedef itk::Local::BlockedRecursiveGaussianImageFilter< TImage, RealImageType > BlockedGaussianFilterType;
+
+  const double numberOfVoxels = input->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  for ( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+    {
+    unsigned int threads = 1;
+    while ( true )
+      {
+      typename GaussianFilterType::Pointer gaussian = GaussianFilterType::New();
+      gaussian->SetInput( input );
+      gaussian->SetSigma( sigma );
+      gaussian->SetDirection( d );
+      gaussian->SetNumberOfThreads( threads );
+
+      typename BlockedGaussianFilterType::Pointer blockedGaussian = BlockedGaussianFilterType::New();
+      blockedGaussian->SetInput( input );
+      blockedGaussian->SetSigma( sigma );
+      blockedGaussian->SetDirection( d );
+      blockedGaussian->SetNumberOfThreads( threads );
+
+      const double seconds = TimeFilter( gaussian.GetPointer(), options.repetitions );
+      const itk::SizeValueType bytes = AllocatedBytes( gaussian.GetPointer() );
+      gaussian = 0;
+      const double blockedSeconds = TimeFilter( blockedGaussian.GetPointer(), options.repetitions );
+      const itk::SizeValueType blockedBytes = AllocatedBytes( blockedGaussian.GetPointer() );
+
+      const char               *names[] = { "RecursiveGaussianImageFilter", "BlockedRecursiveGaussianImageFilter" };
+      const double              times[] = { seconds, blockedSeconds };
+      const itk::SizeValueType  allocatedBytes[] = { bytes, blockedBytes };
+      for ( unsigned int k = 0; k < 2; ++k )
+        {
+        os << "{\"filter\": \"" << names[k] << "\""
+           << ", \"dimension\": " << TImage::ImageDimension
+           << ", \"pixel\": \"" << PixelTypeName( typename TImage::PixelType() ) << "\""
+           << ", \"size\": " << input->GetLargestPossibleRegion().GetSize( 0 )
+           << ", \"sigma\": " << sigma
+           << ", \"direction\": " << d
+           << ", \"threads\": " << threads
+           << ", \"seconds\": " << times[k]
+           << ", \"voxels_per_second\": " << numberOfVoxels / times[k];
+        if ( k == 1 )
+          {
+          os << ", \"speedup\": " << seconds / blockedSeconds;
+          }
+        WriteAllocatedBytes( os, allocatedBytes[k], numberOfVoxels );
+        os << "}" << std::endl;
+        }
+
+      if ( threads >= options.maxThreads )
+        {
+        break;
+        }
+      threads = std::min( 2 * threads, options.maxThreads );
+      }
+    }
+}
+
+// a batch of small images, with the batch filter and with the
+// composite filter updated for each image
+template< unsigned int VDimension, typename TPixel >
+void RunBatchBenchmark( unsigned int imageSize,
+                        double sigma,
+                        const BenchmarkOptions &options,
+                        std::ostream &os )
+{
+  typedef itk::Image< TPixel, VDimension >     ImageType;
+  typedef itk::Image< TPixel, VDimension + 1 > StackedImageType;
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType >     RecursiveFilterType;
+  typedef itk::Local::BatchHessianRecursiveGaussianImageFilter< StackedImageType > BatchFilterType;
+
+  typename StackedImageType::SizeType stackedSize;
+  stackedSize.Fill( imageSize );
+  stackedSize[VDimension] = options.numberOfBatchImages;
+
+  typedef itk::GaussianImageSource< StackedImageType > GaussianSourceType;
+  typename GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( stackedSize );
+  gaussianSource->SetMean( itk::FixedArray< double, VDimension + 1 >( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, VDimension + 1 >( imageSize/4 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  typename StackedImageType::Pointer stacked = gaussianSource->GetOutput();
+  stacked->DisconnectPipeline();
+
+  // every image of the per image run is the first image of the stack,
+  // the time does not depend on the pixels
+  typename ImageType::RegionType region;
+  for ( unsigned int i = 0; i < VDimension; ++i )
+    {
+    region.SetSize( i, imageSize );
+    }
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  std::copy( stacked->GetBufferPointer(), stacked->GetBufferPointer() + region.GetNumberOfPixels(),
+             image->GetBufferPointer() );
+
+  const double numberOfVoxels = stacked->GetLargestPossibleRegion().GetNumberOfPixels();
+  const unsigned int threads = options.maxThreads;
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( threads );
+
+  double             perImageSeconds = std::numeric_limits< double >::max();
+  itk::SizeValueType perImageBytes = 0;
+  for ( unsigned int r = 0; r < options.repetitions; ++r )
+    {
+    itk::TimeProbe probe;
+    probe.Start();
+    for ( unsigned int k = 0; k < options.numberOfBatchImages; ++k )
+      {
+      typename RecursiveFilterType::Pointer filter = RecursiveFilterType::New();
+      filter->SetInput( image );
+      filter->SetSigma( sigma );
+      filter->SetNumberOfThreads( threads );
+      filter->Update();
+      perImageBytes = AllocatedBytes( filter.GetPointer() );
+      }
+    probe.Stop();
+
+    perImageSeconds = std::min< double >( perImageSeconds, probe.GetTotal() );
+    }
+
+  typename BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput( stacked );
+  batchFilter->SetSigma( sigma );
+  batchFilter->SetNumberOfThreads( threads );
+  const double batchSeconds = TimeFilter( batchFilter.GetPointer(), options.repetitions );
+
+  // the per image filter allocates its buffers for one image at a time
+  const double imageVoxels = numberOfVoxels / options.numberOfBatchImages;
+
+  const char               *names[] = { "DiscreteHessianRecursiveGaussianImageFilter+PerImage", "BatchHessianRecursiveGaussianImageFilter" };
+  const double              times[] = { perImageSeconds, batchSeconds };
+  const itk::SizeValueType  allocatedBytes[] = { perImageBytes, AllocatedBytes( batchFilter.GetPointer() ) };
+  const double              allocatedVoxels[] = { imageVoxels, numberOfVoxels };
+  for ( unsigned int k = 0; k < 2; ++k )
+    {
+    os << "{\"filter\": \"" << names[k] << "\""
+       << ", \"dimension\": " << VDimension
+       << ", \"pixel\": \"" << PixelTypeName( TPixel() ) << "\""
+       << ", \"size\": " << imageSize
+       << ", \"images\": " << options.numberOfBatchImages
+       << ", \"sigma\": " << sigma
+       << ", \"threads\": " << threads
+       << ", \"seconds\": " << times[k]
+       << ", \"voxels_per_second\": " << numberOfVoxels / times[k];
+    WriteAllocatedBytes( os, allocatedBytes[k], allocatedVoxels[k] );
+    os << "}" << std::endl;
+    }
+}
+
+template< unsigned int VDimension, typename TPixel >
+void RunDimension( const std::vector< unsigned int > &sizes,
+                   const BenchmarkOptions &options,
+                   std::ostream &os )
+{
+  typedef itk::Image< TPixel, VDimension > ImageType;
+
+  typedef itk::Local::HessianImageFilter< ImageType >                          HessianFilterType;
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > RecursiveFilterType;
+  typedef itk::Local::HessianDiscreteGaussianImageFilter< ImageType >          DiscreteFilterType;
+
+  for ( unsigned int s = 0; s < sizes.size(); ++s )
+    {
+    typename ImageType::SizeType size;
+    size.Fill( sizes[s] );
+
+    typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+    typename GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+    gaussianSource->SetSize( size );
+    gaussianSource->SetMean( itk::FixedArray< double, VDimension >( sizes[s]/2 ) );
+    gaussianSource->SetSigma( itk::FixedArray< double, VDimension >( sizes[s]/4 ) );
+    gaussianSource->SetNormalized( false );
+    gaussianSource->SetScale( 1.0 );
+    gaussianSource->Update();
+
+    typename ImageType::Pointer input = gaussianSource->GetOutput();
+    input->DisconnectPipeline();
+
+    RunBenchmark< HessianFilterType >( "HessianImageFilter", input, 0.0, options, os );
+
+    for ( unsigned int k = 0; k < options.sigmas.size(); ++k )
+      {
+      RunBenchmark< RecursiveFilterType >( "DiscreteHessianRecursiveGaussianImageFilter",
+                                           input, options.sigmas[k], options, os );
+      RunBenchmark< RecursiveFilterType >( "DiscreteHessianRecursiveGaussianImageFilter",
+                                           input, options.sigmas[k], options, os, MiniPipeline );
+      RunBenchmark< RecursiveFilterType >( "DiscreteHessianRecursiveGaussianImageFilter",
+                                           input, options.sigmas[k], options, os, TaskScheduler );
+      RunBenchmark< DiscreteFilterType >( "HessianDiscreteGaussianImageFilter",
+                                          input, options.sigmas[k], options, os );
+      RunAxisBenchmark( input.GetPointer(), options.sigmas[k], options, os );
+      }
+    }
+}
+
+}
+
+int main( int argc, char *argv[] )
+{
+  const std::string outputFileName = ( argc > 1 ) ? argv[1] : "-";
+  const bool        quick = ( argc > 3 && std::string( argv[3] ) == "quick" );
+
+  BenchmarkOptions options;
+  options.maxThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if ( argc > 2 )
+    {
+    options.maxThreads = std::max( 1, atoi( argv[2] ) );
+    }
+
+  if ( quick )
+    {
+    options.sizes2D.push_back( 64 );
+    options.sizes3D.push_back( 16 );
+    options.sigmas.push_back( 1.0 );
+    options.batchSize2D = 16;
+    options.batchSize3D = 8;
+    options.numberOfBatchImages = 4;
+    options.repetitions = 1;
+    }
+  else
+    {
+    options.sizes2D.push_back( 256 );
+    options.sizes2D.push_back( 1024 );
+    options.sizes2D.push_back( 4096 );
+    options.sizes3D.push_back( 64 );
+    options.sizes3D.push_back( 128 );
+    options.sizes3D.push_back( 192 );
+    options.sigmas.push_back( 1.0 );
+    options.sigmas.push_back( 2.0 );
+    options.sigmas.push_back( 4.0 );
+    options.batchSize2D = 64;
+    options.batchSize3D = 64;
+    options.numberOfBatchImages = 256;
+    options.repetitions = 3;
+    }
+
+  std::ofstream outputFile;
+  if ( outputFileName != "-" )
+    {
+    outputFile.open( outputFileName.c_str() );
+    if ( !outputFile )
+      {
+      std::cerr << "Unable to open " << outputFileName << " for writing." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::ostream &os = ( outputFileName != "-" ) ? outputFile : std::cout;
+
+  try
+    {
+    RunDimension< 2, float >( options.sizes2D, options, os );
+    RunDimension< 2, double >( options.sizes2D, options, os );
+    RunDimension< 3, float >( options.sizes3D, options, os );
+    RunDimension< 3, double >( options.sizes3D, options, os );
+
+    for ( unsigned int k = 0; k < options.sigmas.size(); ++k )
+      {
+      RunBatchBenchmark< 2, float >( options.batchSize2D, options.sigmas[k], options, os );
+      RunBatchBenchmark< 3, float >( options.batchSize3D, options.sigmas[k], options, os );
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
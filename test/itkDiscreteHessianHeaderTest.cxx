@@ -6,6 +6,17 @@
 #include <itkHessianImageFilter.h>
 #include <itkDiscreteHessianRecursiveGaussianImageFilter.h>
 #include <itkHessianDiscreteGaussianImageFilter.h>
+#include <itkFusedHessianRecursiveGaussianImageFilter.h>
+#include <itkTiledHessianRecursiveGaussianImageFilter.h>
+#include <itkMemoryMappedImportImageContainer.h>
+#include <itkRecursiveGaussianLineKernel.h>
+#include <itkBlockedRecursiveGaussianImageFilter.h>
+#include <itkBatchHessianRecursiveGaussianImageFilter.h>
+#include <itkHessianOutputPixelTraits.h>
+#include <itkHessianCentralDifferences.h>
+#include <itkHessianPipelineReport.h>
+#include <itkMultiScaleDiscreteHessianRecursiveGaussianImageFilter.h>
+#include <itkDiscreteHessianRecursiveGaussianImageFunction.h>
 
 
 
@@ -0,0 +1,128 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension > ImageType;
+
+// compare the eigenvalues, and eigenvectors when present, with the
+// eigen-analysis of the tensor output
+template< typename TEigenPixel >
+int EigenValuesTest( ImageType *image, bool useFusedKernel )
+{
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef typename HessianFilterType::OutputImageType                         HessianImageType;
+  typedef typename HessianImageType::PixelType                                HessianPixelType;
+
+  typedef itk::Image< TEigenPixel, Dimension >                                               EigenImageType;
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType, EigenImageType > EigenFilterType;
+
+  typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( image );
+  hessian->SetSigma( 2.0 );
+  hessian->NormalizeAcrossScaleOn();
+  hessian->SetUseFusedKernel( useFusedKernel );
+  hessian->Update();
+
+  typename EigenFilterType::Pointer eigen = EigenFilterType::New();
+  eigen->SetInput( image );
+  eigen->SetSigma( 2.0 );
+  eigen->NormalizeAcrossScaleOn();
+  eigen->SetUseFusedKernel( useFusedKernel );
+  eigen->Update();
+
+  itk::ImageRegionConstIterator< HessianImageType > hit( hessian->GetOutput(),
+                                                          hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< EigenImageType > eit( eigen->GetOutput(),
+                                                        eigen->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  double maxResidual = 0.0;
+  for ( ; !hit.IsAtEnd(); ++hit, ++eit )
+    {
+    const HessianPixelType H = hit.Get();
+    const TEigenPixel      e = eit.Get();
+
+    typename HessianPixelType::EigenValuesArrayType eigenValues;
+    H.ComputeEigenValues( eigenValues );
+
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( eigenValues[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( eigenValues[i] - e[i] ) ) );
+      }
+
+    if ( TEigenPixel::Length == Dimension * ( Dimension + 1 ) )
+      {
+      // H v = lambda v
+      for ( unsigned int k = 0; k < Dimension; ++k )
+        {
+        for ( unsigned int i = 0; i < Dimension; ++i )
+          {
+          double Hv = 0.0;
+          for ( unsigned int j = 0; j < Dimension; ++j )
+            {
+            Hv += H(i,j) * e[Dimension + k * Dimension + j];
+            }
+          maxResidual = std::max( maxResidual, std::abs( Hv - e[k] * e[Dimension + k * Dimension + i] ) );
+          }
+        }
+      }
+    }
+
+  std::cout << "Length " << TEigenPixel::Length << ( useFusedKernel ? " fused" : "" ) << std::endl;
+  std::cout << "  maximum eigenvalue: " << maxValue << std::endl;
+  std::cout << "  maximum difference of eigenvalues: " << maxDifference << std::endl;
+  std::cout << "  maximum eigenvector residual: " << maxResidual << std::endl;
+
+  if ( maxDifference > 1e-4 * maxValue || maxResidual > 1e-4 * maxValue )
+    {
+    std::cerr << "Eigen-analysis output differs from the eigen-analysis of the tensor output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkDiscreteHessianRecursiveGaussianImageFilterEigenValuesTest( int argc, char *argv[] )
+{
+  ImageType::SizeType size;
+  size.Fill( 32 );
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 12.0 ) );
+  GaussianSourceType::ArrayType sigma;
+  sigma[0] = 3.0;
+  sigma[1] = 5.0;
+  sigma[2] = 8.0;
+  gaussianSource->SetSigma( sigma );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  typedef itk::FixedArray< float, Dimension >                   EigenValuesPixelType;
+  typedef itk::FixedArray< float, Dimension * ( Dimension + 1 ) > EigenSystemPixelType;
+
+  for ( unsigned int fused = 0; fused < 2; ++fused )
+    {
+    if ( EigenValuesTest< EigenValuesPixelType >( gaussianSource->GetOutput(), fused ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    if ( EigenValuesTest< EigenSystemPixelType >( gaussianSource->GetOutput(), fused ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+int itkDiscreteHessianRecursiveGaussianImageFilterIncrementalTest( int, char *[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 60;
+  size[2] = 56;
+
+  typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 28.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension >( 8.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  ImageType::Pointer input = gaussianSource->GetOutput();
+  input->DisconnectPipeline();
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( input );
+  hessian->SetSigma( 1.5 );
+  hessian->UseIncrementalUpdateOn();
+  hessian->Update();
+
+  const HessianImageType::PixelType *buffer = hessian->GetOutput()->GetBufferPointer();
+
+  // add a small blob to the input, and mark it as dirty
+  ImageType::IndexType dirtyIndex;
+  dirtyIndex[0] = 10;
+  dirtyIndex[1] = 40;
+  dirtyIndex[2] = 20;
+  ImageType::SizeType dirtySize;
+  dirtySize.Fill( 4 );
+  const ImageType::RegionType dirtyRegion( dirtyIndex, dirtySize );
+
+  for ( itk::ImageRegionIterator< ImageType > it( input, dirtyRegion ); !it.IsAtEnd(); ++it )
+    {
+    it.Set( it.Get() + 2.0f );
+    }
+  input->Modified();
+  hessian->AddDirtyRegion( dirtyRegion );
+  hessian->Update();
+
+  if ( hessian->GetDirtyRegion().GetNumberOfPixels() != 0 )
+    {
+    std::cerr << "The dirty region is not cleared by an update!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // only the neighborhood of the dirty region is recomputed
+  if ( hessian->GetReport().GetNumberOfPixels() >= input->GetLargestPossibleRegion().GetNumberOfPixels() / 2 )
+    {
+    std::cerr << "The incremental update recomputed " << hessian->GetReport().GetNumberOfPixels() << " pixels!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( hessian->GetOutput()->GetBufferPointer() != buffer )
+    {
+    std::cerr << "The output is not patched in place!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the patched output is the output of a complete update
+  HessianFilterType::Pointer completeHessian = HessianFilterType::New();
+  completeHessian->SetInput( input );
+  completeHessian->SetSigma( 1.5 );
+  completeHessian->Update();
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > cit( completeHessian->GetOutput(),
+                                                          completeHessian->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  for ( ; !it.IsAtEnd(); ++it, ++cit )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( cit.Get()[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - cit.Get()[i] ) ) );
+      }
+    }
+
+  std::cout << "Maximum value: " << maxValue << std::endl;
+  std::cout << "Maximum difference of incremental output: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-3 * maxValue )
+    {
+    std::cerr << "The incremental output differs from the complete output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // without a dirty region the update is complete
+  hessian->Modified();
+  hessian->Update();
+  if ( hessian->GetReport().GetNumberOfPixels() != input->GetLargestPossibleRegion().GetNumberOfPixels() )
+    {
+    std::cerr << "A modified filter did not update completely!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkMemoryMappedImportImageContainer.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+int itkDiscreteHessianRecursiveGaussianImageFilterMemoryMappingTest( int argc, char *argv[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  // the scratch files are created in the given directory, or the
+  // default temporary directory
+  const std::string directory = ( argc > 1 ) ? argv[1] : "";
+
+  ImageType::SizeType size;
+  size[0] = 41;
+  size[1] = 35;
+  size[2] = 30;
+
+  typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 15.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension >( 6.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+
+  // a memory mapped image is zero and holds what is written
+  typedef itk::Local::MemoryMappedImportImageContainer< itk::SizeValueType, float > ContainerType;
+  ContainerType::Pointer container = ContainerType::New();
+  if ( !directory.empty() )
+    {
+    container->SetDirectory( directory );
+    }
+
+  ImageType::Pointer mapped = ImageType::New();
+  mapped->SetRegions( size );
+  mapped->SetPixelContainer( container );
+  mapped->Allocate();
+
+  const ImageType *source = gaussianSource->GetOutput();
+  const itk::SizeValueType numberOfPixels = mapped->GetLargestPossibleRegion().GetNumberOfPixels();
+  for ( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+    {
+    if ( mapped->GetBufferPointer()[i] != 0.0f )
+      {
+      std::cerr << "A new memory mapped image is not zero!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    mapped->GetBufferPointer()[i] = source->GetBufferPointer()[i];
+    }
+  for ( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+    {
+    if ( mapped->GetBufferPointer()[i] != source->GetBufferPointer()[i] )
+      {
+      std::cerr << "A memory mapped image does not hold its pixels!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+
+  // the memory mapped mode gives the same output as the in memory
+  // modes
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( mapped );
+  hessian->SetSigma( 2.0 );
+  hessian->Update();
+
+  HessianFilterType::Pointer mappedHessian = HessianFilterType::New();
+  mappedHessian->SetInput( mapped );
+  mappedHessian->SetSigma( 2.0 );
+  mappedHessian->UseMemoryMappingOn();
+  mappedHessian->SetMemoryMappingDirectory( directory );
+  mappedHessian->Update();
+
+  typedef itk::Local::MemoryMappedImportImageContainer< itk::SizeValueType, HessianImageType::PixelType > OutputContainerType;
+  if ( dynamic_cast< const OutputContainerType * >( mappedHessian->GetOutput()->GetPixelContainer() ) == 0 )
+    {
+    std::cerr << "The output is not memory mapped!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > mit( mappedHessian->GetOutput(),
+                                                          mappedHessian->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  for ( ; !it.IsAtEnd(); ++it, ++mit )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - mit.Get()[i] ) ) );
+      }
+    }
+
+  std::cout << "Maximum value: " << maxValue << std::endl;
+  std::cout << "Maximum difference of memory mapped output: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-10 * maxValue )
+    {
+    std::cerr << "Memory mapped output differs from the in memory output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the scratch files are released with the output
+  mappedHessian = 0;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+const unsigned int NumberOfComponents = Dimension * ( Dimension + 1 ) / 2;
+
+typedef itk::Image< float, Dimension > ImageType;
+
+typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+enum Mode { MiniPipeline, FusedKernel, TaskScheduler };
+
+template< typename TFilter >
+void ConfigureFilter( TFilter *filter, ImageType *image, Mode mode )
+{
+  filter->SetInput( image );
+  filter->SetSigma( 2.0 );
+  filter->NormalizeAcrossScaleOn();
+  filter->SetUseFusedKernel( mode == FusedKernel );
+  filter->SetUseTaskScheduler( mode == TaskScheduler );
+}
+
+// the maximum difference of the components of a stored output to the
+// double tensor output, and the maximum of the tensor components
+template< typename TImage >
+double MaximumDifference( const HessianImageType *hessian,
+                          const TImage *stored,
+                          double scale,
+                          double &maxValue )
+{
+  itk::ImageRegionConstIterator< HessianImageType > hit( hessian, hessian->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TImage >           sit( stored, stored->GetLargestPossibleRegion() );
+
+  double maxDifference = 0.0;
+  maxValue = 0.0;
+  for ( ; !hit.IsAtEnd(); ++hit, ++sit )
+    {
+    for ( unsigned int k = 0; k < NumberOfComponents; ++k )
+      {
+      maxValue = std::max( maxValue, std::abs( double( hit.Get()[k] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( hit.Get()[k] ) - sit.Get()[k] / scale ) );
+      }
+    }
+  return maxDifference;
+}
+
+int StorageTest( ImageType *image, Mode mode )
+{
+  std::cout << "Mode " << mode << std::endl;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  ConfigureFilter( hessian.GetPointer(), image, mode );
+  hessian->Update();
+
+  double maxValue = 0.0;
+
+  // single precision tensor
+  typedef itk::Image< itk::SymmetricSecondRankTensor< float, Dimension >, Dimension > FloatHessianImageType;
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType, FloatHessianImageType > FloatFilterType;
+
+  FloatFilterType::Pointer floatHessian = FloatFilterType::New();
+  ConfigureFilter( floatHessian.GetPointer(), image, mode );
+  floatHessian->Update();
+
+  const double floatDifference = MaximumDifference( hessian->GetOutput(), floatHessian->GetOutput(), 1.0, maxValue );
+  std::cout << "  maximum value: " << maxValue << std::endl;
+  std::cout << "  maximum difference of float output: " << floatDifference << std::endl;
+  if ( floatDifference > 1e-4 * maxValue )
+    {
+    std::cerr << "Float output differs from the double output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // 16-bit fixed-point, the components are rounded to multiples of
+  // the quantization step, the intermediate images are float
+  typedef itk::Image< itk::FixedArray< short, NumberOfComponents >, Dimension >     FixedPointImageType;
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType, FixedPointImageType > FixedPointFilterType;
+
+  const double quantizationStep = maxValue / 10000.0;
+
+  FixedPointFilterType::Pointer fixedPointHessian = FixedPointFilterType::New();
+  ConfigureFilter( fixedPointHessian.GetPointer(), image, mode );
+  fixedPointHessian->SetOutputScale( 1.0 / quantizationStep );
+  fixedPointHessian->Update();
+
+  // the components are decoded with the scale recorded in the output
+  double recordedScale = 0.0;
+  if ( !itk::ExposeMetaData< double >( fixedPointHessian->GetOutput()->GetMetaDataDictionary(),
+                                       itk::Local::HessianOutputScaleKey(), recordedScale )
+       || recordedScale != 1.0 / quantizationStep )
+    {
+    std::cerr << "The output scale is not recorded in the output, got " << recordedScale << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double fixedPointDifference = MaximumDifference( hessian->GetOutput(), fixedPointHessian->GetOutput(),
+                                                         recordedScale, maxValue );
+  std::cout << "  maximum difference of fixed-point output: " << fixedPointDifference << std::endl;
+  if ( fixedPointDifference > 0.5 * quantizationStep + 1e-4 * maxValue )
+    {
+    std::cerr << "Fixed-point output is not rounded!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // values out of the range of short saturate
+  fixedPointHessian->SetOutputScale( 1.0e6 / maxValue );
+  fixedPointHessian->Update();
+
+  if ( !itk::ExposeMetaData< double >( fixedPointHessian->GetOutput()->GetMetaDataDictionary(),
+                                       itk::Local::HessianOutputScaleKey(), recordedScale )
+       || recordedScale != 1.0e6 / maxValue )
+    {
+    std::cerr << "The recorded output scale is not updated, got " << recordedScale << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator< HessianImageType >    hit( hessian->GetOutput(), hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< FixedPointImageType > fit( fixedPointHessian->GetOutput(),
+                                                            fixedPointHessian->GetOutput()->GetLargestPossibleRegion() );
+  for ( ; !hit.IsAtEnd(); ++hit, ++fit )
+    {
+    for ( unsigned int k = 0; k < NumberOfComponents; ++k )
+      {
+      const double value = hit.Get()[k] * 1.0e6 / maxValue;
+      if ( ( value > 40000.0 && fit.Get()[k] != itk::NumericTraits< short >::max() )
+           || ( value < -40000.0 && fit.Get()[k] != itk::NumericTraits< short >::NonpositiveMin() ) )
+        {
+        std::cerr << "Fixed-point output does not saturate!" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // structure of arrays, one output per component
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType, ImageType > ComponentFilterType;
+
+  ComponentFilterType::Pointer componentHessian = ComponentFilterType::New();
+  ConfigureFilter( componentHessian.GetPointer(), image, mode );
+  componentHessian->Update();
+
+  if ( componentHessian->GetNumberOfOutputs() != NumberOfComponents )
+    {
+    std::cerr << "Expected " << NumberOfComponents << " outputs, got "
+              << componentHessian->GetNumberOfOutputs() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double componentDifference = 0.0;
+  for ( unsigned int k = 0; k < NumberOfComponents; ++k )
+    {
+    itk::ImageRegionConstIterator< HessianImageType > tit( hessian->GetOutput(), hessian->GetOutput()->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType >        cit( componentHessian->GetOutput( k ),
+                                                           componentHessian->GetOutput( k )->GetLargestPossibleRegion() );
+    for ( ; !tit.IsAtEnd(); ++tit, ++cit )
+      {
+      componentDifference = std::max( componentDifference, std::abs( double( tit.Get()[k] ) - cit.Get() ) );
+      }
+    }
+
+  std::cout << "  maximum difference of component outputs: " << componentDifference << std::endl;
+  if ( componentDifference > 1e-4 * maxValue )
+    {
+    std::cerr << "Component outputs differ from the tensor output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkDiscreteHessianRecursiveGaussianImageFilterStorageTest( int, char *[] )
+{
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 32;
+  size[2] = 29;
+
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[1] = 0.8;
+
+  typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 14.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension >( 5.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 100.0 );
+  gaussianSource->Update();
+
+  const Mode modes[] = { MiniPipeline, FusedKernel, TaskScheduler };
+  for ( unsigned int m = 0; m < 3; ++m )
+    {
+    if ( StorageTest( gaussianSource->GetOutput(), modes[m] ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+int itkDiscreteHessianRecursiveGaussianImageFilterStreamingTest( int argc, char *argv[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  const unsigned int imageSize = 64;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[0] = 1.0;
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 10.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( 2.0 );
+  hessian->Update();
+
+  HessianFilterType::Pointer streamedHessian = HessianFilterType::New();
+  streamedHessian->SetInput( gaussianSource->GetOutput() );
+  streamedHessian->SetSigma( 2.0 );
+  streamedHessian->UseStreamingOn();
+
+  typedef itk::StreamingImageFilter< HessianImageType, HessianImageType > StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( streamedHessian->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 4 );
+  streamer->Update();
+
+  // the range of the input values, the documented bound of the
+  // difference is 1e-4 times that range for the default margin
+  double minimumInput = itk::NumericTraits< double >::max();
+  double maximumInput = itk::NumericTraits< double >::NonpositiveMin();
+  itk::ImageRegionConstIterator< ImageType > iit( gaussianSource->GetOutput(),
+                                                  gaussianSource->GetOutput()->GetLargestPossibleRegion() );
+  for ( ; !iit.IsAtEnd(); ++iit )
+    {
+    minimumInput = std::min( minimumInput, double( iit.Get() ) );
+    maximumInput = std::max( maximumInput, double( iit.Get() ) );
+    }
+  const double inputRange = maximumInput - minimumInput;
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > sit( streamer->GetOutput(),
+                                                          streamer->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  while ( !it.IsAtEnd() )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - sit.Get()[i] ) ) );
+      }
+    ++it;
+    ++sit;
+    }
+
+  std::cout << "Range of the input: " << inputRange << std::endl;
+  std::cout << "Maximum value: " << maxValue << std::endl;
+  std::cout << "Maximum difference of streamed output: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-4 * inputRange )
+    {
+    std::cerr << "Streamed output differs from the non-streamed output by more than 1e-4 times the range of the input!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( maxDifference > 1e-3 * maxValue )
+    {
+    std::cerr << "Streamed output differs from the non-streamed output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
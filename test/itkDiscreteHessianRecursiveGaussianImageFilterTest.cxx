@@ -1,5 +1,6 @@
 #include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
 #include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
 
 int itkDiscreteHessianRecursiveGaussianImageFilterTest( int argc, char *argv[] )
 {
@@ -33,7 +34,44 @@ int itkDiscreteHessianRecursiveGaussianImageFilterTest( int argc, char *argv[] )
   ImageType::IndexType idx;
   idx.Fill( imageSize/2 );
 
-  std::cout << hessian->GetOutput()->GetPixel( idx );
+  std::cout << hessian->GetOutput()->GetPixel( idx ) << std::endl;
+
+
+  // Compare the single precision intermediate images against the
+  // double precision ones
+  typedef HessianFilterType::OutputImageType HessianImageType;
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType, HessianImageType, float > FloatHessianFilterType;
+  FloatHessianFilterType::Pointer floatHessian = FloatHessianFilterType::New();
+  floatHessian->SetInput( gaussianSource->GetOutput() );
+  floatHessian->Update();
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > fit( floatHessian->GetOutput(),
+                                                          floatHessian->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  while ( !it.IsAtEnd() )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - fit.Get()[i] ) ) );
+      }
+    ++it;
+    ++fit;
+    }
+
+  std::cout << "Maximum value: " << maxValue << std::endl;
+  std::cout << "Maximum difference with float intermediate images: " << maxDifference
+            << " (relative " << maxDifference / maxValue << ")" << std::endl;
+
+  if ( maxDifference > 1e-3 * maxValue )
+    {
+    std::cerr << "Float intermediate images are not accurate enough!" << std::endl;
+    return EXIT_FAILURE;
+    }
 
   return 0;
 }
@@ -0,0 +1,110 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFunction.h"
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+
+int itkDiscreteHessianRecursiveGaussianImageFunctionTest( int argc, char *argv[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  const unsigned int imageSize = 64;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[1] = 1.2;
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 10.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  const double sigma = 2.0;
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( sigma );
+  hessian->NormalizeAcrossScaleOn();
+  hessian->Update();
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFunction< ImageType > HessianFunctionType;
+  HessianFunctionType::Pointer hessianFunction = HessianFunctionType::New();
+  hessianFunction->SetInputImage( gaussianSource->GetOutput() );
+  hessianFunction->SetSigma( sigma );
+  hessianFunction->NormalizeAcrossScaleOn();
+
+  // indices in the interior, near the center, and on the boundary
+  HessianFunctionType::IndexContainerType indices;
+  for ( unsigned int k = 0; k < 8; ++k )
+    {
+    HessianFunctionType::IndexType index;
+    index[0] = ( 7 * k + 3 ) % imageSize;
+    index[1] = ( 13 * k + 29 ) % imageSize;
+    index[2] = ( 5 * k + 30 ) % imageSize;
+    indices.push_back( index );
+    }
+  HessianFunctionType::IndexType corner;
+  corner.Fill( 0 );
+  indices.push_back( corner );
+  corner.Fill( imageSize - 1 );
+  indices.push_back( corner );
+
+  HessianFunctionType::OutputContainerType outputs;
+  hessianFunction->EvaluateAtIndices( indices, outputs );
+
+  double maxValue = 0.0;
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+      }
+    }
+
+  double maxDifference = 0.0;
+  for ( unsigned int k = 0; k < indices.size(); ++k )
+    {
+    const HessianImageType::PixelType H = hessian->GetOutput()->GetPixel( indices[k] );
+    for ( unsigned int i = 0; i < H.GetNumberOfComponents(); ++i )
+      {
+      maxDifference = std::max( maxDifference, std::abs( double( H[i] - outputs[k][i] ) ) );
+      }
+    std::cout << indices[k] << ": " << outputs[k] << std::endl;
+    }
+
+  std::cout << "Maximum value: " << maxValue << std::endl;
+  std::cout << "Maximum difference of sparse evaluation: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-3 * maxValue )
+    {
+    std::cerr << "Sparse evaluation differs from the filter output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // evaluation at a point
+  ImageType::PointType point;
+  gaussianSource->GetOutput()->TransformIndexToPhysicalPoint( indices[0], point );
+  const HessianFunctionType::OutputType H = hessianFunction->Evaluate( point );
+  for ( unsigned int i = 0; i < H.GetNumberOfComponents(); ++i )
+    {
+    if ( H[i] != outputs[0][i] )
+      {
+      std::cerr << "Evaluate at a point differs from EvaluateAtIndex!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
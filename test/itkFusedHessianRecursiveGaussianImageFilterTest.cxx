@@ -0,0 +1,109 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace
+{
+
+template< unsigned int VDimension >
+int FusedHessianTest( unsigned int imageSize )
+{
+  typedef itk::Image< float, VDimension > ImageType;
+
+  typename ImageType::SizeType size;
+  size.Fill( imageSize );
+  size[0] += 3;
+
+  typename ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[0] = 0.7;
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  typename GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, VDimension>( imageSize/3 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, VDimension>( 6.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef typename HessianFilterType::OutputImageType                         HessianImageType;
+
+  typename HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( 1.5 );
+  hessian->UseFusedKernelOff();
+  hessian->Update();
+
+  typename HessianFilterType::Pointer fusedHessian = HessianFilterType::New();
+  fusedHessian->SetInput( gaussianSource->GetOutput() );
+  fusedHessian->SetSigma( 1.5 );
+  fusedHessian->UseFusedKernelOn();
+  fusedHessian->Update();
+
+  typename HessianFilterType::Pointer tiledHessian = HessianFilterType::New();
+  tiledHessian->SetInput( gaussianSource->GetOutput() );
+  tiledHessian->SetSigma( 1.5 );
+  tiledHessian->UseTaskSchedulerOn();
+  tiledHessian->Update();
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > fit( fusedHessian->GetOutput(),
+                                                          fusedHessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > tit( tiledHessian->GetOutput(),
+                                                          tiledHessian->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  double maxTiledDifference = 0.0;
+  while ( !it.IsAtEnd() )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      maxValue = std::max( maxValue, std::abs( double( it.Get()[i] ) ) );
+      maxDifference = std::max( maxDifference, std::abs( double( it.Get()[i] - fit.Get()[i] ) ) );
+      maxTiledDifference = std::max( maxTiledDifference, std::abs( double( it.Get()[i] - tit.Get()[i] ) ) );
+      }
+    ++it;
+    ++fit;
+    ++tit;
+    }
+
+  std::cout << VDimension << "D maximum value: " << maxValue << std::endl;
+  std::cout << VDimension << "D maximum difference of fused output: " << maxDifference << std::endl;
+  std::cout << VDimension << "D maximum difference of task scheduled output: " << maxTiledDifference << std::endl;
+
+  if ( maxDifference > 1e-10 * maxValue )
+    {
+    std::cerr << "Fused output differs from the mini-pipeline output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( maxTiledDifference > 1e-10 * maxValue )
+    {
+    std::cerr << "Task scheduled output differs from the mini-pipeline output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkFusedHessianRecursiveGaussianImageFilterTest( int argc, char *argv[] )
+{
+  if ( FusedHessianTest<2>( 100 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( FusedHessianTest<3>( 40 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
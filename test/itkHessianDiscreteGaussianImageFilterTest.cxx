@@ -0,0 +1,120 @@
+#include "itkHessianDiscreteGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+int itkHessianDiscreteGaussianImageFilterTest( int argc, char *argv[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  const unsigned int imageSize = 48;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  spacing[0] = 0.8;
+
+  typedef itk::GaussianImageSource<ImageType> GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetSpacing( spacing );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension>( imageSize/2 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension>( 8.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  const double sigma = 1.5;
+
+  typedef itk::Local::HessianDiscreteGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                         HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( sigma );
+  hessian->Update();
+
+  // the streamed output only differs by the rounding of the chunks
+  HessianFilterType::Pointer streamedHessian = HessianFilterType::New();
+  streamedHessian->SetInput( gaussianSource->GetOutput() );
+  streamedHessian->SetSigma( sigma );
+  streamedHessian->NormalizeAcrossScaleOn();
+
+  typedef itk::StreamingImageFilter< HessianImageType, HessianImageType > StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( streamedHessian->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 4 );
+  streamer->Update();
+
+  itk::ImageRegionConstIterator< HessianImageType > it( hessian->GetOutput(),
+                                                         hessian->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< HessianImageType > sit( streamer->GetOutput(),
+                                                          streamer->GetOutput()->GetLargestPossibleRegion() );
+
+  double maxValue = 0.0;
+  double maxDifference = 0.0;
+  while ( !it.IsAtEnd() )
+    {
+    for ( unsigned int i = 0; i < it.Get().GetNumberOfComponents(); ++i )
+      {
+      const double normalized = it.Get()[i] * sigma * sigma;
+      maxValue = std::max( maxValue, std::abs( normalized ) );
+      maxDifference = std::max( maxDifference, std::abs( normalized - sit.Get()[i] ) );
+      }
+    ++it;
+    ++sit;
+    }
+
+  std::cout << "Maximum normalized value: " << maxValue << std::endl;
+  std::cout << "Maximum difference of streamed normalized output: " << maxDifference << std::endl;
+
+  if ( maxDifference > 1e-6 * maxValue )
+    {
+    std::cerr << "Streamed normalized output differs from the non-streamed output!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a small region of interest only requests a padded region of the
+  // input
+  ImageType::RegionType roi;
+  roi.SetIndex( 0, 20 );
+  roi.SetIndex( 1, 20 );
+  roi.SetIndex( 2, 20 );
+  roi.SetSize( 0, 4 );
+  roi.SetSize( 1, 4 );
+  roi.SetSize( 2, 4 );
+
+  HessianFilterType::Pointer roiHessian = HessianFilterType::New();
+  roiHessian->SetInput( gaussianSource->GetOutput() );
+  roiHessian->SetSigma( sigma );
+  roiHessian->GetOutput()->SetRequestedRegion( roi );
+  roiHessian->GetOutput()->Update();
+
+  const ImageType::RegionType inputRegion = gaussianSource->GetOutput()->GetRequestedRegion();
+  std::cout << "Input requested region for the region of interest: " << inputRegion << std::endl;
+
+  if ( !inputRegion.IsInside( roi ) || inputRegion.GetNumberOfPixels() >= gaussianSource->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() )
+    {
+    std::cerr << "The input requested region is not a padded region of interest!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator< HessianImageType > rit( roiHessian->GetOutput(), roi );
+  itk::ImageRegionConstIterator< HessianImageType > wit( hessian->GetOutput(), roi );
+  for ( ; !rit.IsAtEnd(); ++rit, ++wit )
+    {
+    for ( unsigned int i = 0; i < rit.Get().GetNumberOfComponents(); ++i )
+      {
+      if ( std::abs( double( rit.Get()[i] - wit.Get()[i] ) ) > 1e-6 * maxValue )
+        {
+        std::cerr << "Region of interest output differs from the whole output at " << rit.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
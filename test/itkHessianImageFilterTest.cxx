@@ -1,5 +1,8 @@
 #include "itkHessianImageFilter.h"
 #include "itkGaussianImageSource.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkZeroFluxNeumannBoundaryCondition.h"
 
 int itkHessianImageFilterTest( int argc, char *argv[] )
 {
@@ -33,7 +36,165 @@ int itkHessianImageFilterTest( int argc, char *argv[] )
   ImageType::IndexType idx;
   idx.Fill( imageSize/2 );
 
-  std::cout << hessian->GetOutput()->GetPixel( idx );
+  std::cout << hessian->GetOutput()->GetPixel( idx ) << std::endl;
+
+
+  // The central differences are exact for a quadratic, check the
+  // interior of an anisotropic image
+  typedef itk::Image< double, Dimension > QuadraticImageType;
+  QuadraticImageType::SizeType quadraticSize;
+  quadraticSize[0] = 20;
+  quadraticSize[1] = 21;
+  quadraticSize[2] = 22;
+
+  QuadraticImageType::SpacingType quadraticSpacing;
+  quadraticSpacing[0] = 0.5;
+  quadraticSpacing[1] = 1.0;
+  quadraticSpacing[2] = 2.0;
+
+  const double A[Dimension][Dimension] = { {  1.0,  0.5, -0.25 },
+                                           {  0.5,  2.0,  0.3  },
+                                           { -0.25, 0.3, -1.0  } };
+
+  QuadraticImageType::Pointer quadratic = QuadraticImageType::New();
+  quadratic->SetRegions( quadraticSize );
+  quadratic->SetSpacing( quadraticSpacing );
+  quadratic->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< QuadraticImageType > qit( quadratic, quadratic->GetLargestPossibleRegion() );
+  for ( qit.GoToBegin(); !qit.IsAtEnd(); ++qit )
+    {
+    QuadraticImageType::PointType p;
+    quadratic->TransformIndexToPhysicalPoint( qit.GetIndex(), p );
+    double value = 0.0;
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      for ( unsigned int j = 0; j < Dimension; ++j )
+        {
+        value += 0.5 * A[i][j] * p[i] * p[j];
+        }
+      }
+    qit.Set( value );
+    }
+
+  typedef itk::Local::HessianImageFilter< QuadraticImageType > QuadraticHessianFilterType;
+  typedef QuadraticHessianFilterType::OutputImageType          QuadraticHessianImageType;
+  QuadraticHessianFilterType::Pointer quadraticHessian = QuadraticHessianFilterType::New();
+  quadraticHessian->SetInput( quadratic );
+  quadraticHessian->Update();
+
+  QuadraticHessianImageType::RegionType interior = quadratic->GetLargestPossibleRegion();
+  interior.ShrinkByRadius( 1 );
+
+  double maxError = 0.0;
+  itk::ImageRegionIteratorWithIndex< QuadraticHessianImageType > hit( quadraticHessian->GetOutput(), interior );
+  for ( hit.GoToBegin(); !hit.IsAtEnd(); ++hit )
+    {
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      for ( unsigned int j = i; j < Dimension; ++j )
+        {
+        maxError = std::max( maxError, std::abs( hit.Get()(i,j) - A[i][j] ) );
+        }
+      }
+    }
+
+  std::cout << "Maximum error for a quadratic: " << maxError << std::endl;
+  if ( maxError > 1e-8 )
+    {
+    std::cerr << "Hessian of a quadratic is not exact!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  // At the faces the neighbors outside of the image are the boundary
+  // pixels, compare the whole image with the central differences of a
+  // neighborhood iterator with the ZeroFluxNeumannBoundaryCondition
+  typedef itk::ZeroFluxNeumannBoundaryCondition< QuadraticImageType >                   BoundaryConditionType;
+  typedef itk::ConstNeighborhoodIterator< QuadraticImageType, BoundaryConditionType > NeighborhoodIteratorType;
+
+  NeighborhoodIteratorType::RadiusType radius;
+  radius.Fill( 1 );
+  NeighborhoodIteratorType nit( radius, quadratic, quadratic->GetLargestPossibleRegion() );
+
+  maxError = 0.0;
+  double maxValue = 0.0;
+  itk::ImageRegionIteratorWithIndex< QuadraticHessianImageType > bit( quadraticHessian->GetOutput(),
+                                                                      quadratic->GetLargestPossibleRegion() );
+  for ( nit.GoToBegin(), bit.GoToBegin(); !nit.IsAtEnd(); ++nit, ++bit )
+    {
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      NeighborhoodIteratorType::OffsetType plus;
+      NeighborhoodIteratorType::OffsetType minus;
+      plus.Fill( 0 );
+      minus.Fill( 0 );
+      plus[i] = 1;
+      minus[i] = -1;
+      const double hii = ( nit.GetPixel( plus ) + nit.GetPixel( minus ) - 2.0 * nit.GetCenterPixel() )
+        / ( quadraticSpacing[i] * quadraticSpacing[i] );
+      maxValue = std::max( maxValue, std::abs( hii ) );
+      maxError = std::max( maxError, std::abs( bit.Get()(i,i) - hii ) );
+
+      for ( unsigned int j = i + 1; j < Dimension; ++j )
+        {
+        NeighborhoodIteratorType::OffsetType mm = minus;
+        NeighborhoodIteratorType::OffsetType mp = minus;
+        NeighborhoodIteratorType::OffsetType pm = plus;
+        NeighborhoodIteratorType::OffsetType pp = plus;
+        mm[j] = -1;
+        mp[j] = 1;
+        pm[j] = -1;
+        pp[j] = 1;
+        const double hij = ( nit.GetPixel( mm ) - nit.GetPixel( mp ) - nit.GetPixel( pm ) + nit.GetPixel( pp ) )
+          / ( 4.0 * quadraticSpacing[i] * quadraticSpacing[j] );
+        maxValue = std::max( maxValue, std::abs( hij ) );
+        maxError = std::max( maxError, std::abs( bit.Get()(i,j) - hij ) );
+        }
+      }
+    }
+
+  std::cout << "Maximum difference with the ZeroFluxNeumann boundary: " << maxError << std::endl;
+  if ( maxError > 1e-10 * maxValue )
+    {
+    std::cerr << "Hessian at the faces differs from the ZeroFluxNeumann central differences!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  // The scale and the component weights multiply the components
+  QuadraticHessianFilterType::ComponentWeightsType weights;
+  for ( unsigned int k = 0; k < weights.Size(); ++k )
+    {
+    weights[k] = k + 1;
+    }
+
+  QuadraticHessianFilterType::Pointer weightedHessian = QuadraticHessianFilterType::New();
+  weightedHessian->SetInput( quadratic );
+  weightedHessian->SetScale( 2.0 );
+  weightedHessian->SetComponentWeights( weights );
+  weightedHessian->Update();
+
+  maxError = 0.0;
+  itk::ImageRegionIteratorWithIndex< QuadraticHessianImageType > wit( weightedHessian->GetOutput(), interior );
+  for ( wit.GoToBegin(); !wit.IsAtEnd(); ++wit )
+    {
+    unsigned int k = 0;
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      for ( unsigned int j = i; j < Dimension; ++j )
+        {
+        maxError = std::max( maxError, std::abs( wit.Get()(i,j) - 2.0 * weights[k++] * A[i][j] ) );
+        }
+      }
+    }
+
+  std::cout << "Maximum error of the weighted Hessian: " << maxError << std::endl;
+  if ( maxError > 1e-8 )
+    {
+    std::cerr << "Scale and component weights are not applied!" << std::endl;
+    return EXIT_FAILURE;
+    }
 
   return 0;
 }
@@ -0,0 +1,171 @@
+#include "itkDiscreteHessianRecursiveGaussianImageFilter.h"
+#include "itkHessianDiscreteGaussianImageFilter.h"
+#include "itkGaussianImageSource.h"
+
+#include <sstream>
+
+namespace
+{
+
+// check the consistency of a report with the output requested region
+int CheckReport( const itk::Local::HessianPipelineReport & report,
+                 unsigned int numberOfStages,
+                 itk::SizeValueType numberOfPixels )
+{
+  typedef itk::Local::HessianPipelineReport::StageType StageType;
+
+  report.WriteJSON( std::cout );
+
+  if ( report.GetNumberOfStages() != numberOfStages )
+    {
+    std::cerr << "Expected " << numberOfStages << " stages, got " << report.GetNumberOfStages() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( report.GetNumberOfPixels() != numberOfPixels || report.GetWallTime() < 0.0 )
+    {
+    std::cerr << "Wrong number of pixels or time of the run!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double totalWeight = 0.0;
+  for ( unsigned int i = 0; i < report.GetNumberOfStages(); ++i )
+    {
+    const StageType & stage = report.GetStage( i );
+
+    totalWeight += stage.ProgressWeight;
+
+    if ( stage.WallTime < 0.0 || stage.NumberOfThreads < 1 || stage.RegionSize.empty() )
+      {
+      std::cerr << "Stage " << stage.Name << " was not measured!" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // the stages compute the whole image
+    itk::SizeValueType regionPixels = 1;
+    for ( unsigned int k = 0; k < stage.RegionSize.size(); ++k )
+      {
+      regionPixels *= stage.RegionSize[k];
+      }
+    if ( regionPixels != numberOfPixels )
+      {
+      std::cerr << "The region of stage " << stage.Name << " is not the image!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if ( std::abs( totalWeight - 1.0 ) > 1e-6 )
+    {
+    std::cerr << "The progress weights sum to " << totalWeight << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+}
+
+int itkHessianPipelineReportTest( int argc, char *argv[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< float, Dimension > ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 36;
+  size[2] = 32;
+
+  typedef itk::GaussianImageSource< ImageType > GaussianSourceType;
+  GaussianSourceType::Pointer gaussianSource = GaussianSourceType::New();
+  gaussianSource->SetSize( size );
+  gaussianSource->SetMean( itk::FixedArray< double, Dimension >( 16.0 ) );
+  gaussianSource->SetSigma( itk::FixedArray< double, Dimension >( 6.0 ) );
+  gaussianSource->SetNormalized( false );
+  gaussianSource->SetScale( 1.0 );
+  gaussianSource->Update();
+
+  const itk::SizeValueType numberOfPixels = gaussianSource->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  typedef itk::Local::DiscreteHessianRecursiveGaussianImageFilter< ImageType > HessianFilterType;
+  typedef HessianFilterType::OutputImageType                                  HessianImageType;
+
+  HessianFilterType::Pointer hessian = HessianFilterType::New();
+  hessian->SetInput( gaussianSource->GetOutput() );
+  hessian->SetSigma( 2.0 );
+  if ( argc > 1 )
+    {
+    hessian->SetReportFileName( argv[1] );
+    }
+  hessian->Update();
+
+  // the first Gaussian, the in place Gaussian along direction 1, and
+  // the fused Hessian
+  if ( CheckReport( hessian->GetReport(), Dimension, numberOfPixels ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the outputs, except for the in place Gaussian, and the buffers of
+  // the threads
+  const itk::Local::HessianPipelineReport & report = hessian->GetReport();
+  if ( report.GetStage( 0 ).AllocatedBytes <= numberOfPixels * sizeof( HessianFilterType::InternalRealType )
+       || report.GetStage( 1 ).AllocatedBytes == 0
+       || report.GetStage( 2 ).AllocatedBytes <= numberOfPixels * sizeof( HessianImageType::PixelType ) )
+    {
+    std::cerr << "Wrong allocated bytes!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the second run is weighted by the measurements of the first
+  std::vector< double > wallTimes;
+  double                totalWallTime = 0.0;
+  for ( unsigned int i = 0; i < report.GetNumberOfStages(); ++i )
+    {
+    wallTimes.push_back( report.GetStage( i ).WallTime );
+    totalWallTime += report.GetStage( i ).WallTime;
+    }
+
+  hessian->Modified();
+  hessian->Update();
+
+  if ( CheckReport( hessian->GetReport(), Dimension, numberOfPixels ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  for ( unsigned int i = 0; i < wallTimes.size() && totalWallTime > 0.0; ++i )
+    {
+    if ( std::abs( report.GetStage( i ).ProgressWeight - wallTimes[i] / totalWallTime ) > 1e-12 )
+      {
+      std::cerr << "The progress weights are not the measured costs!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // with a different configuration the default weights are used
+  hessian->UseTaskSchedulerOn();
+  hessian->Update();
+
+  if ( CheckReport( hessian->GetReport(), 1, numberOfPixels ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+
+  typedef itk::Local::HessianDiscreteGaussianImageFilter< ImageType > DiscreteHessianFilterType;
+  DiscreteHessianFilterType::Pointer discreteHessian = DiscreteHessianFilterType::New();
+  discreteHessian->SetInput( gaussianSource->GetOutput() );
+  discreteHessian->SetSigma( 1.0 );
+  if ( argc > 1 )
+    {
+    discreteHessian->SetReportFileName( argv[1] );
+    }
+  discreteHessian->Update();
+
+  if ( CheckReport( discreteHessian->GetReport(), 2, numberOfPixels ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}